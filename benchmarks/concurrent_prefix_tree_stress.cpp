@@ -0,0 +1,267 @@
+// Copyright [2021] <Eric Fernandes Evaristo>
+// v1.0.1
+
+// Teste de carga de ConcurrentPrefixTree com leitoras simultâneas e comparação com std::map.
+// Compilação e uso:
+//
+//     g++ -std=c++17 -O1 -g -fsanitize=thread -pthread -Iincludes
+//         -o concurrent_prefix_tree_stress benchmarks/concurrent_prefix_tree_stress.cpp
+//     ./concurrent_prefix_tree_stress --readers 8 --writes 200000 --seed 42
+//     ./concurrent_prefix_tree_stress --readers 150 --writes 2000
+//
+// Metade das palavras é inserida no início e nunca removida; a escritora insere e remove as
+// outras ao acaso. Depois de cada escrita o lookup da palavra alterada e dos prefixos dela é
+// comparado com um std::map das palavras presentes, e no fim todas as palavras e prefixos são
+// comparados. As leitoras pesquisam ao mesmo tempo e verificam o que não depende da ordem das
+// escritas: as palavras fixas sempre são encontradas, e uma palavra encontrada sempre tem a
+// própria posição e comprimento. Com mais de MAX_READERS leitoras, as que não conseguem um
+// anúncio próprio usam o contador compartilhado. O código de saída é 1 caso alguma resposta
+// esteja errada.
+
+#include <concurrent_prefix_tree.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::string;
+using structures::ConcurrentPrefixTree;
+using structures::LookupResult;
+
+// Configuração da execução
+struct Options {
+    unsigned readers = 8;         // Threads leitoras
+    std::size_t writes = 200000;  // Inserções e remoções da escritora
+    std::size_t words = 2000;     // Palavras distintas (metade fixa, metade alterada)
+    std::uint64_t seed = 42;      // Semente dos geradores
+};
+
+/**
+ * Gera palavras distintas em ordem aleatória, com letras de 'a' a 'f' para que muitas
+ * compartilhem prefixos e os caminhos copiados pela escritora se sobreponham.
+ *      Parâmetros:
+ *          count: Quantidade de palavras.
+ *          generator: Gerador de números aleatórios.
+ *      Retorno (std::vector<string>): Palavras geradas.
+ **/
+std::vector<string> generate(std::size_t count, std::mt19937_64& generator) {
+    std::vector<string> words;
+
+    while (words.size() < count) {
+        for (std::size_t i = words.size(); i < count; ++i) {
+            string word(1 + generator() % 8, 'a');
+            for (char& letter : word) {
+                letter = static_cast<char>('a' + generator() % 6);
+            }
+            words.push_back(word);
+        }
+
+        std::sort(words.begin(), words.end());
+        words.erase(std::unique(words.begin(), words.end()), words.end());
+    }
+
+    std::shuffle(words.begin(), words.end(), generator);
+    return words;
+}
+
+/**
+ * Retorna o resultado esperado (LookupResult) de um prefixo segundo o mapa das palavras
+ * presentes, com a posição e o comprimento de cada uma.
+ *      Parâmetros:
+ *          model: Palavras presentes (const std::map&).
+ *          prefix: Prefixo (const string&) pesquisado.
+ **/
+LookupResult expected(const std::map<string, std::pair<unsigned long, unsigned long>>& model,
+                      const string& prefix) {
+    LookupResult result = {0, false, 0, 0};
+
+    for (auto it = model.lower_bound(prefix);
+         it != model.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+        ++result.prefix_count;
+    }
+
+    auto exact = model.find(prefix);
+    if (exact != model.end()) {
+        result.found = true;
+        result.position = exact->second.first;
+        result.length = exact->second.second;
+    }
+
+    return result;
+}
+
+/**
+ * Compara o lookup da árvore com o resultado esperado de um prefixo e exibe a diferença.
+ *      Parâmetros:
+ *          tree: Árvore (const ConcurrentPrefixTree<>&) pesquisada.
+ *          model: Palavras presentes (const std::map&).
+ *          prefix: Prefixo (const string&) pesquisado.
+ *      Retorno (std::size_t): 1 caso sejam diferentes, 0 caso sejam iguais.
+ **/
+std::size_t compare(const ConcurrentPrefixTree<>& tree,
+                    const std::map<string, std::pair<unsigned long, unsigned long>>& model,
+                    const string& prefix) {
+    LookupResult result = tree.lookup(prefix);
+    LookupResult model_result = expected(model, prefix);
+
+    if (result.prefix_count == model_result.prefix_count && result.found == model_result.found &&
+        result.position == model_result.position && result.length == model_result.length) {
+        return 0;
+    }
+
+    std::cerr << "\"" << prefix << "\": (" << result.prefix_count << ", " << result.found << ", "
+              << result.position << ", " << result.length << "), expected ("
+              << model_result.prefix_count << ", " << model_result.found << ", "
+              << model_result.position << ", " << model_result.length << ")" << std::endl;
+    return 1;
+}
+
+/**
+ * Lê as opções da linha de comando.
+ *      Parâmetros:
+ *          argc: Quantidade (int) de argumentos.
+ *          argv: Argumentos (char**).
+ *          options: Configuração (Options&) que recebe os valores.
+ *      Retorno (bool): Indica se as opções são válidas.
+ **/
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        string option = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        string value = argv[++i];
+
+        try {
+            if (option == "--readers") {
+                options.readers = static_cast<unsigned>(std::stoul(value));
+            } else if (option == "--writes") {
+                options.writes = std::stoul(value);
+            } else if (option == "--words") {
+                options.words = std::stoul(value);
+            } else if (option == "--seed") {
+                options.seed = std::stoull(value);
+            } else {
+                return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    return options.readers > 0 && options.readers <= 1024 && options.words >= 2;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " [--readers R] [--writes W] [--words N] [--seed S]"
+                  << std::endl;
+        return 1;
+    }
+
+    std::mt19937_64 generator(options.seed);
+    const std::vector<string> words = generate(options.words, generator);
+    const std::size_t fixed = words.size() / 2;  // Palavras [0, fixed) nunca são removidas
+
+    // A posição e o comprimento dependem só do índice da palavra
+    auto position = [](std::size_t i) { return static_cast<unsigned long>(i * 8); };
+    auto length = [&](std::size_t i) {
+        return static_cast<unsigned long>(words[i].size() + 2 + i % 50);
+    };
+
+    ConcurrentPrefixTree<> tree;
+    std::map<string, std::pair<unsigned long, unsigned long>> model;
+    for (std::size_t i = 0; i < fixed; ++i) {
+        tree.insert(words[i], position(i), length(i));
+        model[words[i]] = {position(i), length(i)};
+    }
+
+    std::atomic<unsigned> ready(0);   // Leitoras que já fizeram uma pesquisa
+    std::atomic<bool> writing(true);  // Indica se a escritora ainda está ativa
+    std::atomic<std::size_t> lookups(0);
+    std::atomic<std::size_t> failures(0);
+
+    // As leitoras continuam até a escritora terminar, então todas ficam ativas ao mesmo tempo
+    auto read = [&](std::uint64_t seed) {
+        std::mt19937_64 local(seed);
+        std::size_t count = 0;
+        bool first = true;
+
+        while (first || writing.load()) {
+            std::size_t i = local() % words.size();
+            LookupResult result = tree.lookup(words[i]);
+
+            bool valid = result.found ? result.position == position(i) &&
+                                            result.length == length(i) &&
+                                            result.prefix_count >= 1
+                                      : i >= fixed;
+            if (!valid) {
+                failures.fetch_add(1);
+            }
+
+            ++count;
+            if (first) {
+                first = false;
+                ready.fetch_add(1);
+            }
+        }
+
+        lookups.fetch_add(count);
+    };
+
+    std::vector<std::thread> readers;
+    for (unsigned i = 0; i < options.readers; ++i) {
+        readers.emplace_back(read, options.seed + 1 + i);
+    }
+    while (ready.load() < options.readers) {
+        std::this_thread::yield();
+    }
+
+    std::size_t mismatches = 0;
+    for (std::size_t write = 0; write < options.writes; ++write) {
+        std::size_t i = fixed + generator() % (words.size() - fixed);
+
+        if (model.count(words[i]) != 0) {
+            tree.remove(words[i]);
+            model.erase(words[i]);
+        } else {
+            tree.insert(words[i], position(i), length(i));
+            model[words[i]] = {position(i), length(i)};
+        }
+
+        // Os prefixos da palavra são os únicos resultados que a escrita alterou
+        for (std::size_t size = 1; size <= words[i].size(); ++size) {
+            mismatches += compare(tree, model, words[i].substr(0, size));
+        }
+    }
+
+    writing.store(false);
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+
+    for (const string& word : words) {
+        for (std::size_t size = 1; size <= word.size(); ++size) {
+            mismatches += compare(tree, model, word.substr(0, size));
+        }
+    }
+    if (tree.size() != model.size()) {
+        std::cerr << "size " << tree.size() << ", expected " << model.size() << std::endl;
+        ++mismatches;
+    }
+
+    std::cout << options.readers << " readers, " << options.writes << " writes, "
+              << lookups.load() << " lookups, " << mismatches << " mismatches, "
+              << failures.load() << " failed reads" << std::endl;
+
+    return mismatches == 0 && failures.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,487 @@
+// Copyright [2021] <Eric Fernandes Evaristo>
+// v1.0.1
+
+// Benchmark da árvore de prefixos com dicionários sintéticos. Compilação e uso:
+//
+//     g++ -std=c++17 -O2 -pthread -Iincludes -o prefix_tree_benchmark
+//         benchmarks/prefix_tree_benchmark.cpp
+//     ./prefix_tree_benchmark --sizes 10000,1000000,50000000 --seed 42 --output run.json
+//
+// O mesmo seed gera sempre os mesmos dicionários e as mesmas consultas, então dois arquivos JSON
+// de versões diferentes da árvore podem ser comparados diretamente.
+
+#include <prefix_tree.h>
+
+#include <unistd.h>  // sysconf
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using std::string;
+using std::string_view;
+using structures::PrefixTree;
+
+typedef std::chrono::steady_clock Clock;
+
+// Frequência das letras no português, de 'a' a 'z', em milésimos
+const double LETTER_FREQUENCY[26] = {146, 10, 39, 50, 126, 10, 13, 13, 62, 4,  1, 28, 47,
+                                     50,  107, 25, 12, 65, 78, 43, 46, 17, 1,  2, 1,  5};
+
+// Terminações comuns que formam famílias de palavras com o mesmo radical
+const char* const ENDINGS[] = {"",      "s",     "a",     "as",    "o",    "os",   "ar",
+                               "er",    "ir",    "ado",   "ada",   "ando", "endo", "indo",
+                               "mente", "cao",   "coes",  "inho",  "inha", "oso",  "osa",
+                               "ista",  "ismo",  "idade", "avel",  "ivel", "eiro", "eira",
+                               "ura",   "agem",  "ante",  "ente",  "aram", "emos", "amos"};
+const std::size_t ENDING_COUNT = sizeof(ENDINGS) / sizeof(ENDINGS[0]);
+
+// Configuração da execução
+struct Options {
+    std::vector<std::size_t> sizes{10000, 100000, 1000000};  // Quantidades de palavras
+    std::uint64_t seed = 42;                                  // Semente dos geradores
+    std::size_t queries = 100000;                             // Consultas por medida
+    unsigned threads = std::thread::hardware_concurrency();   // Threads de build_parallel
+    string output;                                            // Arquivo JSON (vazio: saída)
+};
+
+// Dicionário sintético: as palavras ficam concatenadas em um único texto
+struct Corpus {
+    string text;                                       // Palavras concatenadas
+    std::vector<PrefixTree<>::EntryView> sorted;       // Palavras em ordem alfabética
+    std::vector<std::uint32_t> shuffled;               // Índices de sorted em ordem aleatória
+    std::vector<string> misses;                        // Palavras que não estão no dicionário
+    std::uint64_t file_bytes = 0;                      // Tamanho do arquivo .dic equivalente
+};
+
+// Resumo de uma série de latências
+struct Latency {
+    double p50 = 0.0;   // Mediana (ns)
+    double p99 = 0.0;   // Percentil 99 (ns)
+    double mean = 0.0;  // Média (ns)
+};
+
+/**
+ * Gera uma sequência de letras com a frequência do português.
+ *      Parâmetros:
+ *          generator: Gerador de números aleatórios.
+ *          letters: Distribuição das letras.
+ *          length: Quantidade de letras.
+ *          out: Texto que recebe as letras.
+ **/
+void append_letters(std::mt19937_64& generator, std::discrete_distribution<int>& letters,
+                    std::size_t length, string& out) {
+    for (std::size_t i = 0; i < length; ++i) {
+        out.push_back(static_cast<char>('a' + letters(generator)));
+    }
+}
+
+/**
+ * Gera um dicionário sintético. Cada palavra é um radical seguido de uma terminação comum ou de
+ * letras aleatórias. Os radicais são escolhidos com distribuição log-uniforme (próxima de Zipf),
+ * então poucos radicais formam muitas palavras e a árvore tem prefixos compartilhados como em um
+ * dicionário real. O comprimento médio das palavras fica perto de 9 letras.
+ *      Parâmetros:
+ *          count: Quantidade de palavras distintas.
+ *          seed: Semente do gerador.
+ *          queries: Quantidade de palavras ausentes para as consultas sem acerto.
+ *      Retorno (Corpus): Dicionário gerado.
+ **/
+Corpus generate(std::size_t count, std::uint64_t seed, std::size_t queries) {
+    std::mt19937_64 generator(seed ^ (count * 0x9E3779B97F4A7C15ull));
+    std::discrete_distribution<int> letters(LETTER_FREQUENCY, LETTER_FREQUENCY + 26);
+    std::normal_distribution<double> stem_length(5.0, 1.8);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    // Radicais
+    std::size_t stem_count = count / 6 > 64 ? count / 6 : 64;
+    string stems;
+    std::vector<std::uint32_t> stem_offsets(stem_count + 1, 0);
+    for (std::size_t i = 0; i < stem_count; ++i) {
+        long length = std::lround(stem_length(generator));
+        append_letters(generator, letters, static_cast<std::size_t>(std::clamp(length, 2l, 14l)),
+                       stems);
+        stem_offsets[i + 1] = static_cast<std::uint32_t>(stems.size());
+    }
+
+    auto make_word = [&](string& out) {
+        std::size_t rank = static_cast<std::size_t>(
+                               std::exp(uniform(generator) * std::log(stem_count + 1.0))) - 1;
+        rank = rank < stem_count ? rank : stem_count - 1;
+        out.append(stems, stem_offsets[rank], stem_offsets[rank + 1] - stem_offsets[rank]);
+
+        if (uniform(generator) < 0.7) {
+            out.append(ENDINGS[generator() % ENDING_COUNT]);
+        } else {
+            append_letters(generator, letters, 1 + generator() % 6, out);
+        }
+    };
+
+    // Gera candidatos até haver palavras distintas suficientes. As palavras são guardadas como
+    // posições no texto, que só cresce, e repetidas são descartadas pela ordenação
+    Corpus corpus;
+    corpus.text.reserve(count * 10);  // Fora do buffer curto, as visões sobrevivem ao retorno
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> words;  // Posição e comprimento
+    auto view = [&](const std::pair<std::uint64_t, std::uint32_t>& word) {
+        return string_view(corpus.text.data() + word.first, word.second);
+    };
+
+    while (words.size() < count) {
+        std::size_t missing = count - words.size();
+        for (std::size_t i = 0; i < missing + missing / 8 + 16; ++i) {
+            std::size_t begin = corpus.text.size();
+            make_word(corpus.text);
+            words.push_back({begin, static_cast<std::uint32_t>(corpus.text.size() - begin)});
+        }
+
+        std::sort(words.begin(), words.end(),
+                  [&](const auto& a, const auto& b) { return view(a) < view(b); });
+        words.erase(std::unique(words.begin(), words.end(),
+                                [&](const auto& a, const auto& b) { return view(a) == view(b); }),
+                    words.end());
+    }
+
+    // Descarta o excesso sem favorecer o início do alfabeto
+    std::shuffle(words.begin(), words.end(), generator);
+    words.resize(count);
+    std::sort(words.begin(), words.end(),
+              [&](const auto& a, const auto& b) { return view(a) < view(b); });
+
+    // Posições de um arquivo .dic em ordem alfabética: "[palavra]definição\n"
+    corpus.sorted.reserve(count);
+    for (const auto& word : words) {
+        unsigned long length = word.second + 2 + 20 + generator() % 280;
+        corpus.sorted.push_back({view(word), corpus.file_bytes, length, 0});
+        corpus.file_bytes += length + 1;
+    }
+
+    corpus.shuffled.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        corpus.shuffled[i] = static_cast<std::uint32_t>(i);
+    }
+    std::shuffle(corpus.shuffled.begin(), corpus.shuffled.end(), generator);
+
+    // Palavras ausentes com a mesma distribuição das presentes
+    auto less = [](const PrefixTree<>::EntryView& entry, string_view word) {
+        return entry.prefix < word;
+    };
+    string candidate;
+    while (corpus.misses.size() < queries) {
+        candidate.clear();
+        make_word(candidate);
+        auto it = std::lower_bound(corpus.sorted.begin(), corpus.sorted.end(), candidate, less);
+        if (it == corpus.sorted.end() || it->prefix != candidate) {
+            corpus.misses.push_back(candidate);
+        }
+    }
+
+    return corpus;
+}
+
+/**
+ * Retorna a memória residente do processo em bytes (std::size_t).
+ **/
+std::size_t resident_bytes() {
+    std::ifstream statm("/proc/self/statm");
+    std::size_t pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+/**
+ * Retorna os milissegundos (double) desde um instante.
+ **/
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * Resume uma série de latências.
+ *      Parâmetros:
+ *          samples: Latências em nanossegundos (são ordenadas).
+ *      Retorno (Latency): Mediana, percentil 99 e média.
+ **/
+Latency summarize(std::vector<double>& samples) {
+    Latency latency;
+    if (samples.empty()) {
+        return latency;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    double total = 0.0;
+    for (double sample : samples) {
+        total += sample;
+    }
+
+    latency.p50 = samples[samples.size() / 2];
+    latency.p99 = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+    latency.mean = total / samples.size();
+    return latency;
+}
+
+/**
+ * Mede a latência de uma pesquisa para cada palavra.
+ *      Parâmetros:
+ *          words: Palavras pesquisadas.
+ *          search: Pesquisa, recebe a palavra e retorna um valor.
+ *          sink: Acumula os resultados para que as pesquisas não sejam descartadas.
+ *      Retorno (Latency): Resumo das latências.
+ **/
+template <typename Search>
+Latency measure(const std::vector<string>& words, Search search, unsigned long& sink) {
+    std::vector<double> samples;
+    samples.reserve(words.size());
+
+    for (const string& word : words) {
+        Clock::time_point start = Clock::now();
+        sink += search(word);
+        samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+    }
+
+    return summarize(samples);
+}
+
+/**
+ * Escreve um resumo de latências em JSON.
+ **/
+std::ostream& operator<<(std::ostream& out, const Latency& latency) {
+    return out << "{\"p50_ns\": " << latency.p50 << ", \"p99_ns\": " << latency.p99
+               << ", \"mean_ns\": " << latency.mean << "}";
+}
+
+/**
+ * Executa todas as medidas para um tamanho de dicionário.
+ *      Parâmetros:
+ *          count: Quantidade de palavras.
+ *          options: Configuração da execução.
+ *          json: Saída do objeto JSON da execução.
+ **/
+void run(std::size_t count, const Options& options, std::ostream& json) {
+    Clock::time_point start = Clock::now();
+    Corpus corpus = generate(count, options.seed, options.queries);
+    double generate_ms = elapsed_ms(start);
+
+    std::uint64_t letters = 0;
+    for (const auto& entry : corpus.sorted) {
+        letters += entry.prefix.size();
+    }
+
+    // Consultas com acerto, sorteadas entre as palavras do dicionário
+    std::mt19937_64 generator(options.seed + count);
+    std::vector<string> hits;
+    hits.reserve(options.queries);
+    for (std::size_t i = 0; i < options.queries; ++i) {
+        hits.emplace_back(corpus.sorted[generator() % count].prefix);
+    }
+
+    unsigned long sink = 0;
+
+    // Inserção em ordem aleatória, e memória ocupada pela árvore
+    std::size_t before = resident_bytes();
+    start = Clock::now();
+    std::unique_ptr<PrefixTree<>> tree(new PrefixTree<>());
+    for (std::uint32_t index : corpus.shuffled) {
+        const auto& entry = corpus.sorted[index];
+        tree->insert(entry.prefix, entry.position, entry.length);
+    }
+    double insert_ms = elapsed_ms(start);
+    std::size_t resident = resident_bytes() - before;
+    PrefixTree<>::Stats stats = tree->stats();
+
+    Latency prefix_hit = measure(hits, [&](const string& w) { return tree->prefix_search(w); },
+                                 sink);
+    Latency prefix_miss = measure(corpus.misses,
+                                  [&](const string& w) { return tree->prefix_search(w); }, sink);
+    Latency position_hit = measure(hits,
+                                   [&](const string& w) { return tree->position_search(w); }, sink);
+    Latency position_miss = measure(
+        corpus.misses, [&](const string& w) { return tree->position_search(w); }, sink);
+    Latency length_hit = measure(hits, [&](const string& w) { return tree->length_search(w); },
+                                 sink);
+    Latency length_miss = measure(corpus.misses,
+                                  [&](const string& w) { return tree->length_search(w); }, sink);
+
+    start = Clock::now();
+    sink += tree->aphabetical_order().size();
+    double order_ms = elapsed_ms(start);
+
+    // Remoção de um décimo das palavras
+    std::vector<string> removed;
+    for (std::size_t i = 0; i < count / 10 + 1 && i < count; ++i) {
+        removed.emplace_back(corpus.sorted[corpus.shuffled[i]].prefix);
+    }
+    std::vector<double> samples;
+    samples.reserve(removed.size());
+    start = Clock::now();
+    for (const string& word : removed) {
+        Clock::time_point begin = Clock::now();
+        tree->remove(word);
+        samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - begin).count());
+    }
+    double remove_ms = elapsed_ms(start);
+    Latency remove = summarize(samples);
+
+    start = Clock::now();
+    tree.reset();
+    double teardown_ms = elapsed_ms(start);
+
+    // Construções em lote a partir da lista ordenada
+    start = Clock::now();
+    tree.reset(new PrefixTree<>());
+    tree->build_sorted(corpus.sorted.begin(), corpus.sorted.end());
+    double sorted_ms = elapsed_ms(start);
+
+    // Pesquisas antes e depois de reescrever os nós em uma região contígua
+    auto prefix_search = [&](const string& w) { return tree->prefix_search(w); };
+    Latency arena_hit = measure(hits, prefix_search, sink);
+    start = Clock::now();
+    tree->relayout();
+    double relayout_ms = elapsed_ms(start);
+    Latency relayout_hit = measure(hits, prefix_search, sink);
+    Latency relayout_miss = measure(corpus.misses, prefix_search, sink);
+    tree.reset();
+
+    start = Clock::now();
+    tree.reset(new PrefixTree<>());
+    tree->build_parallel(corpus.sorted.begin(), corpus.sorted.end(), options.threads);
+    double parallel_ms = elapsed_ms(start);
+    tree.reset();
+
+    std::cerr << count << " words: insert " << insert_ms << " ms, "
+              << static_cast<double>(stats.bytes_in_use) / count
+              << " B/word, prefix_search hit p50 " << prefix_hit.p50 << " ns, miss p50 "
+              << prefix_miss.p50 << " ns, after relayout hit p50 " << relayout_hit.p50 << " ns"
+              << std::endl;
+
+    json << "    {\n"
+         << "      \"words\": " << count << ",\n"
+         << "      \"letters\": " << letters << ",\n"
+         << "      \"file_bytes\": " << corpus.file_bytes << ",\n"
+         << "      \"generate_ms\": " << generate_ms << ",\n"
+         << "      \"build\": {\"insert_ms\": " << insert_ms
+         << ", \"build_sorted_ms\": " << sorted_ms << ", \"build_parallel_ms\": " << parallel_ms
+         << "},\n"
+         << "      \"memory\": {\"resident_bytes\": " << resident
+         << ", \"bytes_in_use\": " << stats.bytes_in_use
+         << ", \"bytes_reserved\": " << stats.bytes_reserved
+         << ", \"bytes_per_word\": " << static_cast<double>(stats.bytes_in_use) / count
+         << ", \"nodes\": " << stats.nodes << ", \"max_depth\": " << stats.max_depth
+         << ", \"wasted_bytes\": " << stats.wasted_bytes << "},\n"
+         << "      \"prefix_search\": {\"hit\": " << prefix_hit << ", \"miss\": " << prefix_miss
+         << "},\n"
+         << "      \"position_search\": {\"hit\": " << position_hit
+         << ", \"miss\": " << position_miss << "},\n"
+         << "      \"length_search\": {\"hit\": " << length_hit << ", \"miss\": " << length_miss
+         << "},\n"
+         << "      \"aphabetical_order_ms\": " << order_ms << ",\n"
+         << "      \"remove\": {\"count\": " << removed.size() << ", \"total_ms\": " << remove_ms
+         << ", \"latency\": " << remove << "},\n"
+         << "      \"relayout\": {\"total_ms\": " << relayout_ms
+         << ", \"prefix_search_before\": {\"hit\": " << arena_hit
+         << "}, \"prefix_search_after\": {\"hit\": " << relayout_hit
+         << ", \"miss\": " << relayout_miss << "}},\n"
+         << "      \"teardown_ms\": " << teardown_ms << ",\n"
+         << "      \"checksum\": " << sink << "\n"
+         << "    }";
+}
+
+/**
+ * Lê as opções da linha de comando.
+ *      Parâmetros:
+ *          argc: Quantidade de argumentos.
+ *          argv: Argumentos.
+ *          options: Configuração preenchida.
+ *      Retorno (bool): Falso caso algum argumento seja inválido.
+ **/
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        string option = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        string value = argv[++i];
+
+        try {
+            if (option == "--sizes") {
+                options.sizes.clear();
+                std::stringstream list(value);
+                string size;
+                while (std::getline(list, size, ',')) {
+                    options.sizes.push_back(std::stoul(size));
+                }
+            } else if (option == "--seed") {
+                options.seed = std::stoull(value);
+            } else if (option == "--queries") {
+                options.queries = std::stoul(value);
+            } else if (option == "--threads") {
+                options.threads = static_cast<unsigned>(std::stoul(value));
+            } else if (option == "--output") {
+                options.output = value;
+            } else {
+                return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    for (std::size_t size : options.sizes) {
+        if (size == 0 || size > UINT32_MAX) {
+            return false;
+        }
+    }
+
+    return !options.sizes.empty() && options.queries > 0;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--sizes N,N,...] [--seed S] [--queries Q] [--threads T]"
+                     " [--output FILE]"
+                  << std::endl;
+        return 1;
+    }
+
+    std::ostringstream json;
+    json << "{\n"
+         << "  \"seed\": " << options.seed << ",\n"
+         << "  \"queries\": " << options.queries << ",\n"
+         << "  \"threads\": " << options.threads << ",\n"
+#ifdef __VERSION__
+         << "  \"compiler\": \"" << __VERSION__ << "\",\n"
+#endif
+         << "  \"runs\": [\n";
+
+    for (std::size_t i = 0; i < options.sizes.size(); ++i) {
+        run(options.sizes[i], options, json);
+        json << (i + 1 < options.sizes.size() ? ",\n" : "\n");
+    }
+
+    json << "  ]\n}\n";
+
+    if (options.output.empty()) {
+        std::cout << json.str();
+    } else {
+        std::ofstream file(options.output);
+        file << json.str();
+        if (!file) {
+            std::cerr << "Could not write " << options.output << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,190 @@
+// Copyright [2021] <Eric Fernandes Evaristo>
+// v1.0.1
+
+// Verificação das estruturas de includes/ contra PrefixTree. Compilação e uso:
+//
+//     g++ -std=c++17 -O1 -g -fsanitize=address,undefined -pthread -Iincludes -o structure_check
+//         benchmarks/structure_check.cpp benchmarks/structure_check_exports.cpp
+//     ./structure_check --words 20000 --seed 42
+//
+// As duas unidades de tradução incluem todos os cabeçalhos de includes/, então uma definição
+// fora da classe sem inline falha na ligação. Todas as estruturas recebem as mesmas palavras,
+// parte delas é removida, e o lookup de cada uma é comparado com PrefixTree::lookup nas
+// palavras, em todos os prefixos delas e em palavras ausentes. O código de saída é 1 caso alguma
+// resposta seja diferente.
+
+#include <aho_corasick.h>
+#include <alphabet.h>
+#include <array_list.h>
+#include <bit_vector.h>
+#include <concurrent_prefix_tree.h>
+#include <dawg.h>
+#include <dictionary.h>
+#include <double_array_trie.h>
+#include <lookup_pipeline.h>
+#include <lookup_result.h>
+#include <louds_trie.h>
+#include <node_arena.h>
+#include <operation_stats.h>
+#include <prefix_tree.h>
+#include <radix_tree.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "structure_check.h"
+
+using std::string;
+using structures::ConcurrentPrefixTree;
+using structures::LookupResult;
+using structures::PrefixTree;
+using structures::RadixTree;
+
+// Configuração da execução
+struct Options {
+    std::size_t words = 20000;  // Quantidade de palavras distintas
+    std::uint64_t seed = 42;    // Semente do gerador
+};
+
+/**
+ * Compara o resultado de uma estrutura com o de PrefixTree e exibe a diferença.
+ *      Parâmetros:
+ *          structure: Nome (const char*) da estrutura.
+ *          query: Prefixo (const string&) pesquisado.
+ *          expected: Resultado (const LookupResult&) de PrefixTree.
+ *          result: Resultado (const LookupResult&) da estrutura.
+ *      Retorno (std::size_t): 1 caso sejam diferentes, 0 caso sejam iguais.
+ **/
+std::size_t compare(const char* structure, const string& query, const LookupResult& expected,
+                    const LookupResult& result) {
+    if (result.prefix_count == expected.prefix_count && result.found == expected.found &&
+        result.position == expected.position && result.length == expected.length) {
+        return 0;
+    }
+
+    std::cerr << structure << " \"" << query << "\": (" << result.prefix_count << ", "
+              << result.found << ", " << result.position << ", " << result.length
+              << "), expected (" << expected.prefix_count << ", " << expected.found << ", "
+              << expected.position << ", " << expected.length << ")" << std::endl;
+    return 1;
+}
+
+/**
+ * Gera palavras distintas em ordem aleatória. A maior parte das letras vem de 'a' a 'h', então
+ * as palavras compartilham prefixos e uma pode ser prefixo de outra.
+ *      Parâmetros:
+ *          count: Quantidade de palavras.
+ *          generator: Gerador de números aleatórios.
+ *      Retorno (std::vector<string>): Palavras geradas.
+ **/
+std::vector<string> generate(std::size_t count, std::mt19937_64& generator) {
+    std::vector<string> words;
+
+    while (words.size() < count) {
+        for (std::size_t i = words.size(); i < count; ++i) {
+            string word(1 + generator() % 10, 'a');
+            for (char& letter : word) {
+                std::uint64_t range = generator() % 10 == 0 ? 26 : 8;
+                letter = static_cast<char>('a' + generator() % range);
+            }
+            words.push_back(word);
+        }
+
+        std::sort(words.begin(), words.end());
+        words.erase(std::unique(words.begin(), words.end()), words.end());
+    }
+
+    std::shuffle(words.begin(), words.end(), generator);
+    return words;
+}
+
+/**
+ * Lê as opções da linha de comando.
+ *      Parâmetros:
+ *          argc: Quantidade (int) de argumentos.
+ *          argv: Argumentos (char**).
+ *          options: Configuração (Options&) que recebe os valores.
+ *      Retorno (bool): Indica se as opções são válidas.
+ **/
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        string option = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        string value = argv[++i];
+
+        try {
+            if (option == "--words") {
+                options.words = std::stoul(value);
+            } else if (option == "--seed") {
+                options.seed = std::stoull(value);
+            } else {
+                return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    return options.words > 0;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " [--words N] [--seed S]" << std::endl;
+        return 1;
+    }
+
+    std::mt19937_64 generator(options.seed);
+    std::vector<string> words = generate(options.words, generator);
+
+    PrefixTree<> tree;
+    RadixTree radix;
+    ConcurrentPrefixTree<> concurrent;
+
+    // A posição e o comprimento dependem da palavra, então uma resposta trocada é detectada
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        unsigned long position = i * 8;
+        unsigned long length = words[i].size() + 2 + i % 50;
+        tree.insert(words[i], position, length);
+        radix.insert(words[i], position, length);
+        concurrent.insert(words[i], position, length);
+    }
+
+    // Remove uma palavra a cada cinco, o que também junta e divide nós da RadixTree
+    for (std::size_t i = 0; i < words.size(); i += 5) {
+        tree.remove(words[i]);
+        radix.remove(words[i]);
+        concurrent.remove(words[i]);
+    }
+
+    // Palavras (incluindo as removidas), todos os prefixos delas e palavras ausentes
+    std::vector<string> queries;
+    for (const string& word : words) {
+        for (std::size_t length = 1; length <= word.size(); ++length) {
+            queries.push_back(word.substr(0, length));
+        }
+        queries.push_back(word + "z");
+    }
+
+    std::size_t mismatches = 0;
+    for (const string& query : queries) {
+        LookupResult expected = tree.lookup(query);
+        mismatches += compare("RadixTree", query, expected, radix.lookup(query));
+        mismatches += compare("ConcurrentPrefixTree", query, expected, concurrent.lookup(query));
+    }
+    mismatches += check_exports(tree, queries);
+
+    std::cout << words.size() << " words, " << tree.size() << " after removals, "
+              << queries.size() << " queries, " << mismatches << " mismatches" << std::endl;
+
+    return mismatches == 0 ? 0 : 1;
+}
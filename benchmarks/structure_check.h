@@ -0,0 +1,24 @@
+// Copyright [2021] <Eric Fernandes Evaristo>
+// v1.0.1
+
+#ifndef BENCHMARKS_STRUCTURE_CHECK_H
+#define BENCHMARKS_STRUCTURE_CHECK_H
+
+#include <prefix_tree.h>
+
+#include <cstdint>  // std::size_t
+#include <string>
+#include <vector>
+
+// Compara o resultado de uma estrutura com o de PrefixTree e exibe a diferença. Retorna 1 caso
+// sejam diferentes e 0 caso sejam iguais (definida em structure_check.cpp)
+std::size_t compare(const char* structure, const std::string& query,
+                    const structures::LookupResult& expected,
+                    const structures::LookupResult& result);
+
+// Compara freeze, succinct, minimize e compile_scanner com a árvore e retorna a quantidade de
+// diferenças (definida em structure_check_exports.cpp)
+std::size_t check_exports(const structures::PrefixTree<>& tree,
+                          const std::vector<std::string>& queries);
+
+#endif
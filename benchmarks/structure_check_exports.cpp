@@ -0,0 +1,68 @@
+// Copyright [2021] <Eric Fernandes Evaristo>
+// v1.0.1
+
+// Segunda unidade de tradução de structure_check.cpp. Inclui os mesmos cabeçalhos e compara as
+// estruturas exportadas de PrefixTree com a própria árvore.
+
+#include <aho_corasick.h>
+#include <alphabet.h>
+#include <array_list.h>
+#include <bit_vector.h>
+#include <concurrent_prefix_tree.h>
+#include <dawg.h>
+#include <dictionary.h>
+#include <double_array_trie.h>
+#include <lookup_pipeline.h>
+#include <lookup_result.h>
+#include <louds_trie.h>
+#include <node_arena.h>
+#include <operation_stats.h>
+#include <prefix_tree.h>
+#include <radix_tree.h>
+
+#include <string>
+#include <vector>
+
+#include "structure_check.h"
+
+using std::string;
+using structures::AhoCorasick;
+using structures::Dawg;
+using structures::DoubleArrayTrie;
+using structures::LookupResult;
+using structures::LoudsTrie;
+using structures::PrefixTree;
+
+/**
+ * Compara freeze, succinct, minimize e compile_scanner com a árvore. O autômato de
+ * compile_scanner não conta prefixos, então só a ocorrência da palavra inteira é comparada.
+ *      Parâmetros:
+ *          tree: Árvore (const PrefixTree<>&) de referência.
+ *          queries: Prefixos (const std::vector<string>&) pesquisados.
+ *      Retorno (std::size_t): Quantidade de diferenças.
+ **/
+std::size_t check_exports(const PrefixTree<>& tree, const std::vector<string>& queries) {
+    DoubleArrayTrie frozen = tree.freeze();
+    LoudsTrie<> succinct = tree.succinct();
+    Dawg<> minimal = tree.minimize();
+    AhoCorasick<> scanner = tree.compile_scanner();
+
+    std::size_t mismatches = 0;
+    for (const string& query : queries) {
+        LookupResult expected = tree.lookup(query);
+        mismatches += compare("DoubleArrayTrie", query, expected, frozen.lookup(query));
+        mismatches += compare("LoudsTrie", query, expected, succinct.lookup(query));
+        mismatches += compare("Dawg", query, expected, minimal.lookup(query));
+
+        // A palavra inteira é a ocorrência que termina no fim do texto com todas as letras
+        LookupResult scanned = {expected.prefix_count, false, 0, 0};
+        scanner.scan(query, [&](const AhoCorasick<>::Match& match) {
+            if (match.end == query.size() && match.letters == query.size()) {
+                scanned = {expected.prefix_count, true, match.position, match.length};
+            }
+        });
+        mismatches += compare("AhoCorasick", query, expected, scanned);
+    }
+
+    return mismatches;
+}
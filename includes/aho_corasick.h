@@ -0,0 +1,280 @@
+// Copyright [2021] <Eric Fernandes Evaristo>
+// v1.0.1
+
+#ifndef STRUCTURES_AHO_CORASICK_H
+#define STRUCTURES_AHO_CORASICK_H
+
+#include <algorithm>    // std::lower_bound
+#include <cstdint>      // std::size_t, std::uint32_t, std::uint64_t
+#include <stdexcept>    // C++ exceptions
+#include <string_view>  // std::string_view
+#include <vector>
+
+#include "alphabet.h"
+#include "prefix_tree.h"
+
+namespace structures {
+
+template <typename Alphabet>
+class PrefixTree;
+
+// Classe AhoCorasick, autômato que encontra todas as ocorrências dos prefixos de uma árvore em
+// um texto com uma única passagem. Os estados são os nós da árvore numerados em largura (a raiz
+// é o estado 0). Cada estado tem um link de falha, que leva ao estado do maior sufixo do seu
+// prefixo que também está na árvore, e um link de saída, que leva ao próximo prefixo completo
+// nessa cadeia de sufixos. O autômato é construído por PrefixTree::compile_scanner, definida no
+// fim deste arquivo, e não muda
+template <typename Alphabet = LowercaseAscii>
+class AhoCorasick {
+   public:
+    // Ocorrência de um prefixo no texto
+    struct Match {
+        std::uint64_t end;       // Posição no texto logo depois da última letra
+        std::size_t letters;     // Quantidade de letras do prefixo
+        unsigned long position;  // Posição do prefixo no arquivo do dicionário
+        unsigned long length;    // Comprimento da linha do prefixo no dicionário
+    };
+
+    // Estado de uma leitura em partes. O mesmo cursor deve ser passado para todas as partes de
+    // um texto, então uma ocorrência dividida entre duas partes também é encontrada
+    struct Cursor {
+        std::uint32_t state = 0;   // Estado do autômato
+        std::uint64_t offset = 0;  // Bytes já lidos
+    };
+
+    // Construtor padrão (nenhum prefixo)
+    AhoCorasick();
+    // Lê uma parte do texto, continuando de um cursor
+    template <typename Callback>
+    void scan(std::string_view text, Cursor& cursor, Callback callback) const;
+    // Lê um texto inteiro
+    template <typename Callback>
+    void scan(std::string_view text, Callback callback) const;
+    // Verifica se o autômato não tem prefixos
+    bool empty() const;
+    // Retorna a quantidade de estados
+    std::size_t states() const;
+
+   private:
+    template <typename>
+    friend class PrefixTree;
+
+    static constexpr std::uint32_t NONE = 0;  // Link vazio (a raiz nunca é um prefixo completo)
+
+    std::vector<std::uint32_t> _root;         // Filho da raiz de cada letra (NONE caso não exista)
+    std::vector<std::uint32_t> _first_edge;   // Primeira aresta de cada estado
+    std::vector<unsigned char> _edge_key;     // Letra de cada aresta, em ordem em cada estado
+    std::vector<std::uint32_t> _edge_target;  // Estado de destino de cada aresta
+    std::vector<std::uint32_t> _fail;         // Link de falha de cada estado
+    std::vector<std::uint32_t> _output;       // Link de saída de cada estado
+    std::vector<std::uint32_t> _depth;        // Quantidade de letras de cada estado
+    std::vector<unsigned long> _position;     // Posição de cada estado
+    std::vector<unsigned long> _length;       // Comprimento de cada estado (0: não é prefixo)
+
+    // Retorna o filho de um estado pela letra
+    std::uint32_t child(std::uint32_t state, unsigned char key) const;
+    // Retorna o próximo estado depois de uma letra, seguindo os links de falha
+    std::uint32_t next(std::uint32_t state, unsigned char key) const;
+    // Calcula os links de falha e de saída
+    void link();
+};
+
+}  // namespace structures
+
+/**
+ * Constrói um objeto structures::AhoCorasick sem prefixos. Apenas a raiz existe.
+ **/
+template <typename Alphabet>
+structures::AhoCorasick<Alphabet>::AhoCorasick()
+    : _root(Alphabet::SIZE, NONE),
+      _first_edge(2, 0),
+      _fail(1, 0),
+      _output(1, NONE),
+      _depth(1, 0),
+      _position(1, 0),
+      _length(1, 0) {}
+
+/**
+ * Lê uma parte do texto e informa cada ocorrência de um prefixo, inclusive as sobrepostas e as
+ * que começaram em partes anteriores. Um byte fora do alfabeto interrompe as ocorrências e os
+ * bytes que o alfabeto ignora não mudam o estado.
+ *      Parâmetros:
+ *          text: Parte (std::string_view) do texto.
+ *          cursor: Estado (Cursor&) da leitura, atualizado no fim da parte.
+ *          callback: Função chamada com cada ocorrência (const Match&).
+ **/
+template <typename Alphabet>
+template <typename Callback>
+void structures::AhoCorasick<Alphabet>::scan(std::string_view text, Cursor& cursor,
+                                             Callback callback) const {
+    std::uint32_t state = cursor.state;
+    std::uint64_t offset = cursor.offset;
+
+    for (char character : text) {
+        ++offset;
+        int key = Alphabet::index(static_cast<unsigned char>(character));
+
+        if (key == AlphabetIndex::SKIP) {
+            continue;
+        }
+        if (key == AlphabetIndex::INVALID) {
+            state = 0;
+            continue;
+        }
+
+        state = next(state, static_cast<unsigned char>(key));
+
+        // O próprio estado e os sufixos completos pela cadeia de saída
+        std::uint32_t found = _length[state] != 0 ? state : _output[state];
+        while (found != NONE) {
+            callback(Match{offset, _depth[found], _position[found], _length[found]});
+            found = _output[found];
+        }
+    }
+
+    cursor.state = state;
+    cursor.offset = offset;
+}
+
+/**
+ * Lê um texto inteiro e informa cada ocorrência de um prefixo.
+ *      Parâmetros:
+ *          text: Texto (std::string_view).
+ *          callback: Função chamada com cada ocorrência (const Match&).
+ **/
+template <typename Alphabet>
+template <typename Callback>
+void structures::AhoCorasick<Alphabet>::scan(std::string_view text, Callback callback) const {
+    Cursor cursor;
+    scan(text, cursor, callback);
+}
+
+/**
+ * Retorna verdadeiro caso o autômato não tenha prefixos.
+ **/
+template <typename Alphabet>
+bool structures::AhoCorasick<Alphabet>::empty() const {
+    return states() == 1;
+}
+
+/**
+ * Retorna a quantidade de estados (std::size_t), incluindo a raiz.
+ **/
+template <typename Alphabet>
+std::size_t structures::AhoCorasick<Alphabet>::states() const {
+    return _fail.size();
+}
+
+/**
+ * Retorna o filho de um estado pela letra. As arestas de cada estado estão em ordem, então a
+ * busca é binária.
+ *      Parâmetros:
+ *          state: Estado (std::uint32_t).
+ *          key: Índice (unsigned char) da letra.
+ *      Retorno (std::uint32_t): Filho (NONE caso não exista).
+ **/
+template <typename Alphabet>
+std::uint32_t structures::AhoCorasick<Alphabet>::child(std::uint32_t state,
+                                                      unsigned char key) const {
+    if (state == 0) {
+        return _root[key];
+    }
+
+    auto begin = _edge_key.begin() + _first_edge[state];
+    auto end = _edge_key.begin() + _first_edge[state + 1];
+    auto it = std::lower_bound(begin, end, key);
+
+    return it != end && *it == key ? _edge_target[it - _edge_key.begin()] : NONE;
+}
+
+/**
+ * Retorna o próximo estado depois de uma letra. Enquanto o estado não tiver o filho da letra, o
+ * link de falha é seguido; na raiz, uma letra sem filho mantém a raiz.
+ *      Parâmetros:
+ *          state: Estado (std::uint32_t) atual.
+ *          key: Índice (unsigned char) da letra.
+ *      Retorno (std::uint32_t): Próximo estado.
+ **/
+template <typename Alphabet>
+std::uint32_t structures::AhoCorasick<Alphabet>::next(std::uint32_t state,
+                                                     unsigned char key) const {
+    while (true) {
+        std::uint32_t target = child(state, key);
+        if (target != NONE || state == 0) {
+            return target;
+        }
+        state = _fail[state];
+    }
+}
+
+/**
+ * Calcula os links de falha e de saída. Os estados estão numerados em largura, então quando um
+ * estado é visitado os links de todos os estados mais rasos já existem.
+ **/
+template <typename Alphabet>
+void structures::AhoCorasick<Alphabet>::link() {
+    for (std::uint32_t state = 0; state < states(); ++state) {
+        for (std::uint32_t edge = _first_edge[state]; edge < _first_edge[state + 1]; ++edge) {
+            std::uint32_t target = _edge_target[edge];
+            std::uint32_t fail = state == 0 ? 0 : next(_fail[state], _edge_key[edge]);
+
+            _fail[target] = fail;
+            _output[target] = _length[fail] != 0 ? fail : _output[fail];
+        }
+    }
+}
+
+/**
+ * Constrói um autômato de Aho-Corasick com os prefixos da árvore. Os nós são numerados em
+ * largura, as arestas de cada estado ficam em ordem alfabética e depois os links de falha e de
+ * saída são calculados. O autômato é independente da árvore, então continua válido depois de
+ * inserções e remoções (mas não as vê).
+ *      Retorno (AhoCorasick<Alphabet>): Autômato que encontra os prefixos em um texto.
+ **/
+template <typename Alphabet>
+structures::AhoCorasick<Alphabet> structures::PrefixTree<Alphabet>::compile_scanner() const {
+    if (_pool.size() >= UINT32_MAX) {  // Os estados são índices de 32 bits
+        throw std::out_of_range("Tree too large");
+    }
+
+    AhoCorasick<Alphabet> scanner;
+    std::vector<const Node*> queue;  // Fila da busca em largura (nulo representa a raiz)
+    queue.reserve(_pool.size() + 1);
+    queue.push_back(nullptr);
+
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        scanner._first_edge[head] = static_cast<std::uint32_t>(scanner._edge_key.size());
+
+        // Cada filho recebe o próximo estado e herda a profundidade do pai mais um
+        auto add = [&](unsigned char key, const Node* child) {
+            std::uint32_t target = static_cast<std::uint32_t>(queue.size());
+            scanner._edge_key.push_back(key);
+            scanner._edge_target.push_back(target);
+            scanner._fail.push_back(0);
+            scanner._output.push_back(0);
+            scanner._depth.push_back(scanner._depth[head] + 1);
+            scanner._position.push_back(child->position());
+            scanner._length.push_back(child->length());
+            queue.push_back(child);
+        };
+
+        if (queue[head] == nullptr) {
+            for (std::size_t i = 0; i < Alphabet::SIZE; ++i) {
+                if (_root[i] != nullptr) {
+                    scanner._root[i] = static_cast<std::uint32_t>(queue.size());
+                    add(static_cast<unsigned char>(i), _root[i]);
+                }
+            }
+        } else {
+            queue[head]->for_each_child(add);
+        }
+
+        scanner._first_edge.resize(head + 2);
+        scanner._first_edge[head + 1] = static_cast<std::uint32_t>(scanner._edge_key.size());
+    }
+
+    scanner.link();
+    return scanner;
+}
+
+#endif
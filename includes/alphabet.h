@@ -0,0 +1,130 @@
+// Copyright [2021] <Eric Fernandes Evaristo>
+// v1.0.1
+
+#ifndef STRUCTURES_ALPHABET_H
+#define STRUCTURES_ALPHABET_H
+
+#include <array>    // std::array
+#include <cstdint>  // std::size_t, std::int16_t
+
+namespace structures {
+
+// Tabela que converte cada byte no índice de uma letra do alfabeto
+typedef std::array<std::int16_t, 256> AlphabetTable;
+
+// Valores especiais da tabela de um alfabeto
+struct AlphabetIndex {
+    static constexpr std::int16_t INVALID = -1;  // O byte não pertence ao alfabeto
+    static constexpr std::int16_t SKIP = -2;     // O byte é ignorado (início de uma letra)
+};
+
+/**
+ * Constrói a tabela das letras minúsculas 'a' a 'z'.
+ *      Retorno (AlphabetTable): Tabela com os índices 0 a 25.
+ **/
+constexpr AlphabetTable lowercase_ascii_table() {
+    AlphabetTable table{};
+
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        table[i] = AlphabetIndex::INVALID;
+    }
+    for (std::size_t i = 0; i < 26; ++i) {
+        table['a' + i] = static_cast<std::int16_t>(i);
+    }
+
+    return table;
+}
+
+/**
+ * Constrói a tabela em que cada byte é uma letra.
+ *      Retorno (AlphabetTable): Tabela com os índices 0 a 255.
+ **/
+constexpr AlphabetTable byte_table() {
+    AlphabetTable table{};
+
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        table[i] = static_cast<std::int16_t>(i);
+    }
+
+    return table;
+}
+
+/**
+ * Constrói a tabela de UTF-8 com as letras acentuadas do Latin-1 trocadas pela letra sem
+ * acento. Maiúsculas são trocadas pelas minúsculas. As letras acentuadas ocupam dois bytes, 0xC3
+ * e um byte de continuação: o 0xC3 é ignorado e o byte de continuação dá a letra. Outros bytes
+ * de início de sequência não pertencem ao alfabeto, então um byte de continuação sempre segue um
+ * 0xC3 em um texto válido.
+ *      Retorno (AlphabetTable): Tabela com os índices 0 a 25.
+ **/
+constexpr AlphabetTable utf8_folded_table() {
+    // Letra sem acento dos caracteres U+00C0 a U+00FF ('-' para os que não são letras)
+    const char folded[] = "aaaaaa-ceeeeiiiidnooooo-ouuuuy--aaaaaa-ceeeeiiiidnooooo-ouuuuy-y";
+    AlphabetTable table = lowercase_ascii_table();
+
+    for (std::size_t i = 0; i < 26; ++i) {
+        table['A' + i] = static_cast<std::int16_t>(i);
+    }
+
+    table[0xC3] = AlphabetIndex::SKIP;
+    for (std::size_t i = 0; i < 64; ++i) {
+        if (folded[i] != '-') {
+            table[0x80 + i] = static_cast<std::int16_t>(folded[i] - 'a');
+        }
+    }
+
+    return table;
+}
+
+// Alfabeto das letras minúsculas 'a' a 'z'
+struct LowercaseAscii {
+    static constexpr std::size_t SIZE = 26;  // Quantidade de letras
+    static constexpr AlphabetTable TABLE = lowercase_ascii_table();
+
+    /**
+     * Retorna o índice (std::int16_t) da letra do byte, ou um valor de AlphabetIndex.
+     **/
+    static constexpr std::int16_t index(unsigned char byte) { return TABLE[byte]; }
+
+    /**
+     * Retorna o caractere (char) de um índice.
+     **/
+    static constexpr char symbol(std::size_t key) { return static_cast<char>('a' + key); }
+};
+
+// Alfabeto de todos os bytes, para chaves binárias
+struct Byte {
+    static constexpr std::size_t SIZE = 256;  // Quantidade de letras
+    static constexpr AlphabetTable TABLE = byte_table();
+
+    /**
+     * Retorna o índice (std::int16_t) da letra do byte, ou um valor de AlphabetIndex.
+     **/
+    static constexpr std::int16_t index(unsigned char byte) { return TABLE[byte]; }
+
+    /**
+     * Retorna o caractere (char) de um índice.
+     **/
+    static constexpr char symbol(std::size_t key) { return static_cast<char>(key); }
+};
+
+// Alfabeto de texto UTF-8 em que acentos e maiúsculas são ignorados ("Ação" e "acao" são o mesmo
+// prefixo). As palavras devolvidas pela árvore usam as letras sem acento
+struct Utf8Folded {
+    static constexpr std::size_t SIZE = 26;  // Quantidade de letras
+    static constexpr AlphabetTable TABLE = utf8_folded_table();
+
+    /**
+     * Retorna o índice (std::int16_t) da letra do byte, ou um valor de AlphabetIndex.
+     **/
+    static constexpr std::int16_t index(unsigned char byte) { return TABLE[byte]; }
+
+    /**
+     * Retorna o caractere (char) de um índice.
+     **/
+    static constexpr char symbol(std::size_t key) { return static_cast<char>('a' + key); }
+};
+
+}  // namespace structures
+
+#endif
@@ -4,24 +4,47 @@
 #ifndef STRUCTURES_ARRAY_LIST_H
 #define STRUCTURES_ARRAY_LIST_H
 
-#include <cstdint>  // std::size_t
+#include <algorithm>    // std::lower_bound, std::move_backward
+#include <cstdint>      // std::size_t
+#include <cstring>      // std::memcpy, std::memmove
+#include <memory>       // std::allocator, std::uninitialized_move
+#include <new>          // placement new
+#include <stdexcept>    // C++ exceptions
+#include <type_traits>  // std::is_trivially_copyable
+#include <utility>      // std::move, std::forward
 
 namespace structures {
 
 template <typename T>
-//  Classe ArrayList, Lista em vetor
+//  Classe ArrayList, Lista em vetor. A capacidade dobra quando a lista fica cheia, então as
+//  inserções no fim custam O(1) amortizado
 class ArrayList {
    public:
     // Construtor padrão
     ArrayList();
     // Construtor com parâmetro
     explicit ArrayList(std::size_t max_size);
+    // Construtor de cópia
+    ArrayList(const ArrayList& other);
+    // Construtor de movimento
+    ArrayList(ArrayList&& other) noexcept;
     // Destrutor
     ~ArrayList();
+    // Atribuição por cópia
+    ArrayList& operator=(const ArrayList& other);
+    // Atribuição por movimento
+    ArrayList& operator=(ArrayList&& other) noexcept;
     // Limpa a lista
     void clear();
+    // Reserva espaço para uma quantidade de dados
+    void reserve(std::size_t capacity);
     // Insere no fim
     void push_back(const T& data);
+    // Insere no fim movendo o dado
+    void push_back(T&& data);
+    // Constrói um dado no fim
+    template <typename... Args>
+    T& emplace_back(Args&&... args);
     // Insere no início
     void push_front(const T& data);
     // Insere na posição
@@ -58,35 +81,89 @@ class ArrayList {
     const T& operator[](std::size_t index) const;
 
    private:
-    T* contents;            // Dados
+    T* contents;            // Dados (apenas as posições menores que size_ estão construídas)
     std::size_t size_;      // Tamanho
-    std::size_t max_size_;  // Tamanho máximo
+    std::size_t max_size_;  // Tamanho máximo (capacidade alocada)
 
     static const auto DEFAULT_MAX = 10u;
+
+    // Indica se os dados podem ser deslocados byte a byte
+    static constexpr bool TRIVIAL = std::is_trivially_copyable<T>::value;
+
+    // Aloca espaço sem construir os dados
+    static T* allocate(std::size_t capacity);
+    // Libera o espaço alocado
+    static void deallocate(T* data, std::size_t capacity);
+    // Retorna a capacidade depois de um crescimento
+    std::size_t grown() const;
+    // Troca o espaço por um de outra capacidade, movendo os dados
+    void reallocate(std::size_t capacity);
+    // Abre uma posição vazia no índice deslocando os dados seguintes
+    void open_gap(std::size_t index);
+    // Fecha a posição do índice deslocando os dados seguintes
+    void close_gap(std::size_t index);
 };
 
 }  // namespace structures
 
 /**
- * Constrói um objeto structures::ArrayList<T>.
+ * Constrói um objeto structures::ArrayList<T>. Nada é alocado até a primeira inserção.
  **/
 template <typename T>
 structures::ArrayList<T>::ArrayList() {
-    max_size_ = DEFAULT_MAX;      // Inicializa o tamanho máximo
-    contents = new T[max_size_];  // Inicializa a array
-    size_ = 0;                    // Inicializa o tamanho
+    max_size_ = 0;       // Inicializa o tamanho máximo
+    contents = nullptr;  // Inicializa a array
+    size_ = 0;           // Inicializa o tamanho
 }
 
 /**
  * Constrói um objeto structures::ArrayList<T>.
  *      Parâmetros:
- *          max_size (std::size_t): tamanho máximo.
+ *          max_size (std::size_t): capacidade inicial.
  **/
 template <typename T>
 structures::ArrayList<T>::ArrayList(std::size_t max_size) {
-    max_size_ = max_size;         // Inicializa o tamanho máximo
-    contents = new T[max_size_];  // Inicializa a array
-    size_ = 0;                    // Inicializa o tamanho
+    max_size_ = max_size;            // Inicializa o tamanho máximo
+    contents = allocate(max_size_);  // Inicializa a array
+    size_ = 0;                       // Inicializa o tamanho
+}
+
+/**
+ * Constrói um objeto structures::ArrayList<T> com uma cópia dos dados de outra lista.
+ *      Parâmetros:
+ *          other (const ArrayList&): Lista copiada.
+ **/
+template <typename T>
+structures::ArrayList<T>::ArrayList(const ArrayList& other) {
+    max_size_ = other.size_;
+    contents = allocate(max_size_);
+    size_ = 0;
+
+    try {
+        for (; size_ < other.size_; ++size_) {
+            new (contents + size_) T(other.contents[size_]);
+        }
+    } catch (...) {
+        clear();
+        deallocate(contents, max_size_);
+        throw;
+    }
+}
+
+/**
+ * Constrói um objeto structures::ArrayList<T> tomando os dados de outra lista, que fica vazia.
+ *      Parâmetros:
+ *          other (ArrayList&&): Lista movida.
+ **/
+template <typename T>
+structures::ArrayList<T>::ArrayList(ArrayList&& other) noexcept {
+    contents = other.contents;
+    size_ = other.size_;
+    max_size_ = other.max_size_;
+
+    other.contents = nullptr;
+    other.size_ = 0;
+    other.max_size_ = 0;
 }
 
 /**
@@ -94,17 +171,76 @@ structures::ArrayList<T>::ArrayList(std::size_t max_size) {
  **/
 template <typename T>
 structures::ArrayList<T>::~ArrayList() {
-    delete[] contents;  // Apaga a array de conteúdo
+    clear();                          // Destrói os dados
+    deallocate(contents, max_size_);  // Apaga a array de conteúdo
+}
+
+/**
+ * Substitui os dados pela cópia dos dados de outra lista.
+ *      Parâmetros:
+ *          other (const ArrayList&): Lista copiada.
+ *      Retorno (ArrayList&): A própria lista.
+ **/
+template <typename T>
+structures::ArrayList<T>& structures::ArrayList<T>::operator=(const ArrayList& other) {
+    if (this != &other) {
+        ArrayList copy(other);  // Caso a cópia falhe a lista continua intacta
+        *this = std::move(copy);
+    }
+
+    return *this;
 }
 
 /**
- * Limpa a lista.
+ * Substitui os dados pelos dados de outra lista, que fica vazia.
+ *      Parâmetros:
+ *          other (ArrayList&&): Lista movida.
+ *      Retorno (ArrayList&): A própria lista.
+ **/
+template <typename T>
+structures::ArrayList<T>& structures::ArrayList<T>::operator=(ArrayList&& other) noexcept {
+    if (this != &other) {
+        clear();
+        deallocate(contents, max_size_);
+
+        contents = other.contents;
+        size_ = other.size_;
+        max_size_ = other.max_size_;
+
+        other.contents = nullptr;
+        other.size_ = 0;
+        other.max_size_ = 0;
+    }
+
+    return *this;
+}
+
+/**
+ * Limpa a lista. A capacidade é mantida.
  **/
 template <typename T>
 void structures::ArrayList<T>::clear() {
+    if constexpr (!std::is_trivially_destructible<T>::value) {
+        for (std::size_t i = 0; i < size_; ++i) {
+            contents[i].~T();
+        }
+    }
+
     size_ = 0;  // Redefine o tamanho
 }
 
+/**
+ * Garante espaço para uma quantidade de dados sem novas alocações.
+ *      Parâmetros:
+ *          capacity (std::size_t): Quantidade de dados.
+ **/
+template <typename T>
+void structures::ArrayList<T>::reserve(std::size_t capacity) {
+    if (capacity > max_size_) {
+        reallocate(capacity);
+    }
+}
+
 /**
  * Insere um dado no final da lista.
  *      Parâmetros:
@@ -112,36 +248,70 @@ void structures::ArrayList<T>::clear() {
  **/
 template <typename T>
 void structures::ArrayList<T>::push_back(const T& data) {
-    // Caso a lista não esteja cheia adiciona os dados no final
-
-    if (!full()) {
-        contents[size_++] = data;
-    } else {
-        throw std::out_of_range("Lista cheia");
-    }
+    emplace_back(data);
 }
 
 /**
- * Insere um dado no início da lista.
+ * Insere um dado no final da lista movendo o dado.
  *      Parâmetros:
  *          data (T): dado a ser inserido.
  **/
 template <typename T>
-void structures::ArrayList<T>::push_front(const T& data) {
-    // Caso a lista não esteja cheia adiciona os dados no início
+void structures::ArrayList<T>::push_back(T&& data) {
+    emplace_back(std::move(data));
+}
 
-    if (!full()) {
-        // Empurra todos os dados para frente
-        for (std::size_t i = size(); i > 0; --i) {
-            contents[i] = contents[i - 1];
+/**
+ * Constrói um dado no final da lista. Caso a lista esteja cheia a capacidade dobra.
+ *      Parâmetros:
+ *          args: Argumentos do construtor do dado.
+ *      Retorno (T&): Dado construído.
+ **/
+template <typename T>
+template <typename... Args>
+T& structures::ArrayList<T>::emplace_back(Args&&... args) {
+    if (full()) {
+        // O novo dado é construído antes de mover os antigos, pois os argumentos podem ser
+        // referências para dados da própria lista
+        std::size_t capacity = grown();
+        T* data = allocate(capacity);
+
+        try {
+            new (data + size_) T(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(data, capacity);
+            throw;
+        }
+
+        if constexpr (TRIVIAL) {
+            if (size_ > 0) {
+                std::memcpy(static_cast<void*>(data), contents, size_ * sizeof(T));
+            }
+        } else {
+            std::uninitialized_move(contents, contents + size_, data);
+            for (std::size_t i = 0; i < size_; ++i) {
+                contents[i].~T();
+            }
         }
 
-        // Incrementa o tamanho e adiciona o dado
-        ++size_;
-        contents[0] = data;
+        deallocate(contents, max_size_);
+        contents = data;
+        max_size_ = capacity;
     } else {
-        throw std::out_of_range("Lista cheia");
+        new (contents + size_) T(std::forward<Args>(args)...);
     }
+
+    return contents[size_++];
+}
+
+/**
+ * Insere um dado no início da lista.
+ *      Parâmetros:
+ *          data (T): dado a ser inserido.
+ **/
+template <typename T>
+void structures::ArrayList<T>::push_front(const T& data) {
+    insert(data, 0);
 }
 
 /**
@@ -152,69 +322,39 @@ void structures::ArrayList<T>::push_front(const T& data) {
  **/
 template <typename T>
 void structures::ArrayList<T>::insert(const T& data, std::size_t index) {
-    // Caso a lista não esteja cheia adiciona os dados na posição
+    if (index > size()) {  // Verifica se a posição é válida
+        throw std::out_of_range("Posição inválida");
+    }
 
-    if (!full()) {
-        if (index <= size() && index >= 0) {  // Verifica se a posição é válida
-            // Empurra os dados depois da posição para frente
-            for (std::size_t i = size(); i > index; --i) {
-                contents[i] = contents[i - 1];
-            }
+    if (index == size()) {
+        emplace_back(data);
+        return;
+    }
 
-            // Incrementa o tamanho e adiciona o dado
-            ++size_;
-            contents[index] = data;
-        } else {
-            throw std::out_of_range("Posição inválida");
-        }
+    T element(data);  // O dado pode pertencer à lista, então é copiado antes do deslocamento
 
+    if (full()) {
+        reallocate(grown());
+    }
+
+    open_gap(index);
+
+    if constexpr (TRIVIAL) {
+        std::memcpy(static_cast<void*>(contents + index), &element, sizeof(T));
     } else {
-        throw std::out_of_range("Lista cheia");
+        contents[index] = std::move(element);
     }
 }
 
 /**
- * Insere um dado em ordem.
+ * Insere um dado em ordem. A posição é encontrada por busca binária, antes dos dados iguais.
  *      Parâmetros:
  *          data (T): Dado a ser inserido.
  **/
 template <typename T>
 void structures::ArrayList<T>::insert_sorted(const T& data) {
-    // Caso a lista não esteja cheia adiciona os dados em ordem
-
-    if (!full()) {
-        bool inserted = false;  // Variável para saber se está inserido
-
-        /* O valor é comparado com cada valor da lista do fim ao início. Quando
-           o valor da lista é menor do que o valor a ser inserido é feita a
-           inserção.
-        */
-
-        // O loop itera do final ao início
-        for (std::size_t i = size() - 1; i >= 0; --i) {
-            // Checa se o valor é maior do que o dado na posição
-            if (data > contents[i]) {
-                if (i + 1 < static_cast<int>(size())) {
-                    // Insere no meio
-                    insert(data, i + 1);
-                } else {
-                    // Insere no fim
-                    push_back(data);
-                }
-
-                inserted = true;  // Confirma que inseriu o valor
-                break;
-            }
-        }
-
-        // Caso o valor não tenha sido inserido antes ele é inserido no início
-        if (!inserted) {
-            push_front(data);
-        }
-
-    } else {
-        throw std::out_of_range("Lista cheia");
-    }
+    T* position = std::lower_bound(contents, contents + size_, data);
+    insert(data, static_cast<std::size_t>(position - contents));
 }
 
 /**
@@ -225,47 +365,35 @@ void structures::ArrayList<T>::insert_sorted(const T& data) {
  **/
 template <typename T>
 T structures::ArrayList<T>::pop(std::size_t index) {
-    // Retira o dado na posição caso a lista não esteja vazia
-
-    if (!empty()) {
-        // Verifica se a posição é válida
-        if (index <= size() - 1 && index >= 0) {
-            T element = contents[index];  // Obtém o dado
+    if (empty()) {
+        throw std::out_of_range("Lista vazia");
+    }
 
-            // Empurra a lista após o dado para o início
-            for (std::size_t i = index; i < size(); ++i) {
-                contents[i] = contents[i + 1];
-            }
+    if (index >= size()) {  // Verifica se a posição é válida
+        throw std::out_of_range("Posição inválida");
+    }
 
-            // Decrementa o tamanho e retorna o dado
-            --size_;
-            return element;
-        } else {
-            throw std::out_of_range("Posição inválida");
-        }
+    T element(std::move(contents[index]));  // Obtém o dado
+    close_gap(index);
 
-    } else {
-        throw std::out_of_range("Lista vazia");
-    }
+    return element;
 }
 
 /**
- * Retorna e remove um dado no fim da lista.
+ * Retorna e remove um dado no fim da lista em tempo constante.
  *      Retorna o dado (T).
  **/
 template <typename T>
 T structures::ArrayList<T>::pop_back() {
-    // Retira o dado no fim caso a lista não esteja vazia
-
-    if (!empty()) {
-        T element = contents[size() - 1];  // Obtém o dado
-
-        // Decrementa o tamanho e retorna o dado
-        --size_;
-        return element;
-    } else {
+    if (empty()) {
         throw std::out_of_range("Lista vazia");
     }
+
+    --size_;
+    T element(std::move(contents[size_]));  // Obtém o dado
+    contents[size_].~T();
+
+    return element;
 }
 
 /**
@@ -274,20 +402,7 @@ T structures::ArrayList<T>::pop_back() {
  **/
 template <typename T>
 T structures::ArrayList<T>::pop_front() {
-    if (!empty()) {
-        T element = contents[0];  // Obtém o dado
-
-        // Empurra a lista para o início
-        for (std::size_t i = 0; i < size(); ++i) {
-            contents[i] = contents[i + 1];
-        }
-
-        // Decrementa o tamanho e retorna o dado
-        --size_;
-        return element;
-    } else {
-        throw std::out_of_range("Lista vazia");
-    }
+    return pop(0);
 }
 
 /**
@@ -307,18 +422,12 @@ void structures::ArrayList<T>::remove(const T& data) {
 }
 
 /**
- * Checa se a lista está cheia.
+ * Checa se a lista está cheia, ou seja, se a próxima inserção vai realocar a lista.
  *      Retorna verdadeiro caso a lista esteja cheia.
  **/
 template <typename T>
 bool structures::ArrayList<T>::full() const {
-    // Verifica se a lista está cheia
-
-    if (size() == max_size()) {
-        return true;
-    } else {
-        return false;
-    }
+    return size() == max_size();
 }
 
 /**
@@ -327,13 +436,7 @@ bool structures::ArrayList<T>::full() const {
  **/
 template <typename T>
 bool structures::ArrayList<T>::empty() const {
-    // Verifica se a lista está vazia
-
-    if (size() == 0) {
-        return true;
-    } else {
-        return false;
-    }
+    return size() == 0;
 }
 
 /**
@@ -344,25 +447,11 @@ bool structures::ArrayList<T>::empty() const {
  **/
 template <typename T>
 bool structures::ArrayList<T>::contains(const T& data) const {
-    // Verifica se a lista contém o dado
-
-    bool dataFound = false;  // Variável para armazenar o estado do dado
-
-    if (!empty()) {                      // Caso a lista não esteja vazia
-        std::size_t index = find(data);  // Procura o dado e obtém o seu índice
-
-        // Caso o íncide corresponda ao dado isso significa que ele está na
-        // lista e não ocorreu um erro
-        if (index < max_size()) {
-            if (contents[index] == data) {
-                dataFound = true;
-            }
-        }
-    } else {
+    if (empty()) {
         throw std::out_of_range("Lista vazia");
     }
 
-    return dataFound;  // Retorna o estado da procura do dado
+    return find(data) < size();
 }
 
 /**
@@ -399,7 +488,7 @@ std::size_t structures::ArrayList<T>::size() const {
 }
 
 /**
- * Retorna o tamanho máximo da lista (std::size_t).
+ * Retorna o tamanho máximo da lista (std::size_t) antes da próxima realocação.
  **/
 template <typename T>
 std::size_t structures::ArrayList<T>::max_size() const {
@@ -435,20 +524,15 @@ T& structures::ArrayList<T>::operator[](std::size_t index) {
  **/
 template <typename T>
 const T& structures::ArrayList<T>::at(std::size_t index) const {
-    // Retorna o dado na posição caso a lista não esteja vazia e a posição seja
-    // válida
-
-    if (!empty()) {  // Verifica se a lista está vazia
-        // Verifica se a posição é valida
-        if (index <= size() - 1 && index >= 0) {
-            return contents[index];  // Retorna o dado
-        } else {
-            throw std::out_of_range("Posição inválida");
-        }
-
-    } else {
+    if (empty()) {  // Verifica se a lista está vazia
         throw std::out_of_range("Lista vazia");
     }
+
+    if (index >= size()) {  // Verifica se a posição é valida
+        throw std::out_of_range("Posição inválida");
+    }
+
+    return contents[index];  // Retorna o dado
 }
 
 /**
@@ -462,4 +546,105 @@ const T& structures::ArrayList<T>::operator[](std::size_t index) const {
     return contents[index];
 }
 
+/**
+ * Aloca espaço para dados sem construí-los.
+ *      Parâmetros:
+ *          capacity (std::size_t): Quantidade de dados.
+ *      Retorno (T*): Espaço alocado (nulo caso a quantidade seja zero).
+ **/
+template <typename T>
+T* structures::ArrayList<T>::allocate(std::size_t capacity) {
+    return capacity > 0 ? std::allocator<T>().allocate(capacity) : nullptr;
+}
+
+/**
+ * Libera o espaço alocado. Os dados já devem ter sido destruídos.
+ *      Parâmetros:
+ *          data (T*): Espaço alocado.
+ *          capacity (std::size_t): Quantidade de dados do espaço.
+ **/
+template <typename T>
+void structures::ArrayList<T>::deallocate(T* data, std::size_t capacity) {
+    if (data != nullptr) {
+        std::allocator<T>().deallocate(data, capacity);
+    }
+}
+
+/**
+ * Retorna a capacidade (std::size_t) depois de um crescimento: o dobro da atual.
+ **/
+template <typename T>
+std::size_t structures::ArrayList<T>::grown() const {
+    return max_size_ < DEFAULT_MAX ? DEFAULT_MAX : max_size_ * 2;
+}
+
+/**
+ * Troca o espaço alocado por um de outra capacidade, movendo os dados para ele.
+ *      Parâmetros:
+ *          capacity (std::size_t): Nova capacidade (não menor que o tamanho).
+ **/
+template <typename T>
+void structures::ArrayList<T>::reallocate(std::size_t capacity) {
+    T* data = allocate(capacity);
+
+    if constexpr (TRIVIAL) {
+        if (size_ > 0) {
+            std::memcpy(static_cast<void*>(data), contents, size_ * sizeof(T));
+        }
+    } else {
+        try {
+            std::uninitialized_move(contents, contents + size_, data);
+        } catch (...) {
+            deallocate(data, capacity);
+            throw;
+        }
+
+        for (std::size_t i = 0; i < size_; ++i) {
+            contents[i].~T();
+        }
+    }
+
+    deallocate(contents, max_size_);
+    contents = data;
+    max_size_ = capacity;
+}
+
+/**
+ * Desloca os dados a partir do índice uma posição para frente e incrementa o tamanho. A lista
+ * não pode estar cheia e o índice deve ser menor que o tamanho. A posição do índice fica com um
+ * dado movido, pronto para receber uma atribuição.
+ *      Parâmetros:
+ *          index (std::size_t): Índice da posição aberta.
+ **/
+template <typename T>
+void structures::ArrayList<T>::open_gap(std::size_t index) {
+    if constexpr (TRIVIAL) {
+        std::memmove(static_cast<void*>(contents + index + 1), contents + index,
+                     (size_ - index) * sizeof(T));
+    } else {
+        new (contents + size_) T(std::move(contents[size_ - 1]));
+        std::move_backward(contents + index, contents + size_ - 1, contents + size_);
+    }
+
+    ++size_;
+}
+
+/**
+ * Desloca os dados depois do índice uma posição para trás e decrementa o tamanho.
+ *      Parâmetros:
+ *          index (std::size_t): Índice da posição fechada.
+ **/
+template <typename T>
+void structures::ArrayList<T>::close_gap(std::size_t index) {
+    if constexpr (TRIVIAL) {
+        std::memmove(static_cast<void*>(contents + index), contents + index + 1,
+                     (size_ - index - 1) * sizeof(T));
+    } else {
+        std::move(contents + index + 1, contents + size_, contents + index);
+        contents[size_ - 1].~T();
+    }
+
+    --size_;
+}
+
 #endif
@@ -0,0 +1,344 @@
+// Copyright [2021] <Eric Fernandes Evaristo>
+// v1.0.1
+
+#ifndef STRUCTURES_BIT_VECTOR_H
+#define STRUCTURES_BIT_VECTOR_H
+
+#include <cstdint>    // std::size_t, std::uint32_t, std::uint64_t
+#include <stdexcept>  // C++ exceptions
+#include <vector>
+
+namespace structures {
+
+// Classe BitVector, vetor de bits com rank e select. Os bits são adicionados no fim e depois
+// build cria os índices: a quantidade de uns antes de cada bloco de 512 bits e, a cada 4096
+// zeros, o bloco em que o zero está. O rank lê um contador e no máximo 8 palavras; o select0
+// faz uma busca binária entre dois blocos amostrados e depois percorre as palavras de um bloco
+class BitVector {
+   public:
+    // Construtor
+    BitVector();
+    // Adiciona um bit no fim
+    void push_back(bool bit);
+    // Cria os índices de rank e select (deve ser chamado depois do último bit)
+    void build();
+    // Retorna um bit
+    bool operator[](std::size_t index) const;
+    // Retorna a quantidade de bits
+    std::size_t size() const;
+    // Retorna a quantidade de uns antes de uma posição
+    std::size_t rank1(std::size_t index) const;
+    // Retorna a quantidade de zeros antes de uma posição
+    std::size_t rank0(std::size_t index) const;
+    // Retorna a posição de um zero pela sua ordem
+    std::size_t select0(std::size_t rank) const;
+    // Retorna a posição do primeiro zero a partir de uma posição
+    std::size_t next_zero(std::size_t index) const;
+    // Retorna os bytes usados pelos bits e pelos índices
+    std::size_t bytes() const;
+
+   private:
+    std::vector<std::uint64_t> _words;         // Bits, 64 por palavra
+    std::vector<std::uint64_t> _blocks;        // Uns antes de cada bloco (e o total no fim)
+    std::vector<std::uint32_t> _zero_samples;  // Bloco de cada SAMPLE-ésimo zero
+    std::size_t _size;                         // Quantidade de bits
+
+    // Retorna a quantidade de zeros antes de um bloco
+    std::size_t zeros_before(std::size_t block) const;
+
+    static const std::size_t WORDS_PER_BLOCK = 8;  // 512 bits por bloco
+    static const std::size_t SAMPLE = 4096;        // Zeros entre duas amostras
+};
+
+// Classe PackedArray, vetor de inteiros sem sinal que usa a mesma quantidade de bits para cada
+// valor, a menor que cabe o maior valor. Um valor pode ficar dividido entre duas palavras
+class PackedArray {
+   public:
+    // Construtor
+    explicit PackedArray(std::uint64_t max_value = 0);
+    // Adiciona um valor no fim
+    void push_back(std::uint64_t value);
+    // Retorna um valor
+    std::uint64_t operator[](std::size_t index) const;
+    // Retorna a quantidade de valores
+    std::size_t size() const;
+    // Retorna a quantidade de bits de cada valor
+    unsigned width() const;
+    // Retorna os bytes usados pelos valores
+    std::size_t bytes() const;
+
+   private:
+    std::vector<std::uint64_t> _words;  // Valores, um depois do outro
+    std::size_t _size;                  // Quantidade de valores
+    unsigned _width;                    // Bits de cada valor (0 caso todos sejam 0)
+};
+
+}  // namespace structures
+
+/**
+ * Constrói um objeto structures::BitVector vazio.
+ **/
+inline structures::BitVector::BitVector() {
+    _size = 0;
+}
+
+/**
+ * Adiciona um bit no fim. Os índices deixam de valer até a próxima chamada de build.
+ *      Parâmetros:
+ *          bit: Valor (bool) do bit.
+ **/
+inline void structures::BitVector::push_back(bool bit) {
+    if (_size % 64 == 0) {
+        _words.push_back(0);
+    }
+    if (bit) {
+        _words.back() |= std::uint64_t(1) << (_size % 64);
+    }
+    ++_size;
+}
+
+/**
+ * Cria os índices de rank e select a partir dos bits atuais.
+ **/
+inline void structures::BitVector::build() {
+    std::size_t blocks = (_words.size() + WORDS_PER_BLOCK - 1) / WORDS_PER_BLOCK;
+
+    _blocks.assign(blocks + 1, 0);
+    _zero_samples.clear();
+
+    std::uint64_t ones = 0;
+    for (std::size_t block = 0; block < blocks; ++block) {
+        _blocks[block] = ones;
+
+        std::size_t end = block * WORDS_PER_BLOCK + WORDS_PER_BLOCK;
+        end = end < _words.size() ? end : _words.size();
+        for (std::size_t word = block * WORDS_PER_BLOCK; word < end; ++word) {
+            ones += static_cast<std::uint64_t>(__builtin_popcountll(_words[word]));
+        }
+
+        // Zeros válidos até o fim do bloco (os bits depois do último não contam)
+        std::size_t bits = end * 64 < _size ? end * 64 : _size;
+        std::size_t block_zeros = bits - static_cast<std::size_t>(ones);
+        while (_zero_samples.size() * SAMPLE < block_zeros) {
+            _zero_samples.push_back(static_cast<std::uint32_t>(block));
+        }
+    }
+    _blocks[blocks] = ones;
+}
+
+/**
+ * Retorna o bit (bool) de uma posição.
+ *      Parâmetros:
+ *          index: Posição (std::size_t) do bit, menor que size().
+ **/
+inline bool structures::BitVector::operator[](std::size_t index) const {
+    if (index >= _size) {
+        throw std::out_of_range("Invalid index");
+    }
+
+    return (_words[index / 64] >> (index % 64)) & 1u;
+}
+
+/**
+ * Retorna a quantidade de bits (std::size_t).
+ **/
+inline std::size_t structures::BitVector::size() const {
+    return _size;
+}
+
+/**
+ * Retorna a quantidade de uns (std::size_t) nas posições menores que a do parâmetro.
+ *      Parâmetros:
+ *          index: Posição (std::size_t), no máximo size().
+ **/
+inline std::size_t structures::BitVector::rank1(std::size_t index) const {
+    std::size_t word = index / 64;
+    std::size_t rank = static_cast<std::size_t>(_blocks[word / WORDS_PER_BLOCK]);
+
+    for (std::size_t i = word - word % WORDS_PER_BLOCK; i < word; ++i) {
+        rank += static_cast<std::size_t>(__builtin_popcountll(_words[i]));
+    }
+    if (index % 64 != 0) {
+        std::uint64_t mask = (std::uint64_t(1) << (index % 64)) - 1;
+        rank += static_cast<std::size_t>(__builtin_popcountll(_words[word] & mask));
+    }
+
+    return rank;
+}
+
+/**
+ * Retorna a quantidade de zeros (std::size_t) nas posições menores que a do parâmetro.
+ *      Parâmetros:
+ *          index: Posição (std::size_t), no máximo size().
+ **/
+inline std::size_t structures::BitVector::rank0(std::size_t index) const {
+    return index - rank1(index);
+}
+
+/**
+ * Retorna a posição do zero de uma ordem. A amostra do zero limita os blocos em que ele pode
+ * estar, a busca binária acha o bloco e as palavras do bloco são percorridas até a dele.
+ *      Parâmetros:
+ *          rank: Ordem (std::size_t) do zero, a partir de 0.
+ *      Retorno (std::size_t): Posição do zero.
+ **/
+inline std::size_t structures::BitVector::select0(std::size_t rank) const {
+    if (rank >= _size - static_cast<std::size_t>(_blocks.back())) {
+        throw std::out_of_range("Invalid rank");
+    }
+
+    // Último bloco com menos de rank + 1 zeros antes dele
+    std::size_t sample = rank / SAMPLE;
+    std::size_t low = _zero_samples[sample];
+    std::size_t high = sample + 1 < _zero_samples.size() ? _zero_samples[sample + 1] + 1
+                                                         : _blocks.size() - 1;
+    while (high - low > 1) {
+        std::size_t middle = low + (high - low) / 2;
+        if (zeros_before(middle) <= rank) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+
+    // Palavra do zero e posição dele na palavra
+    std::size_t remaining = rank - zeros_before(low);
+    std::size_t word = low * WORDS_PER_BLOCK;
+    while (true) {
+        std::uint64_t zeros = ~_words[word];
+        std::size_t count = static_cast<std::size_t>(__builtin_popcountll(zeros));
+        if (remaining < count) {
+            for (std::size_t i = 0; i < remaining; ++i) {
+                zeros &= zeros - 1;
+            }
+            return word * 64 + static_cast<std::size_t>(__builtin_ctzll(zeros));
+        }
+        remaining -= count;
+        ++word;
+    }
+}
+
+/**
+ * Retorna a posição do primeiro zero a partir de uma posição.
+ *      Parâmetros:
+ *          index: Posição (std::size_t) inicial.
+ *      Retorno (std::size_t): Posição do zero (size() caso não exista).
+ **/
+inline std::size_t structures::BitVector::next_zero(std::size_t index) const {
+    std::size_t word = index / 64;
+    if (word >= _words.size()) {
+        return _size;
+    }
+
+    std::uint64_t zeros = ~_words[word] & (~std::uint64_t(0) << (index % 64));
+    while (zeros == 0 && ++word < _words.size()) {
+        zeros = ~_words[word];
+    }
+    if (zeros == 0) {
+        return _size;
+    }
+
+    std::size_t position = word * 64 + static_cast<std::size_t>(__builtin_ctzll(zeros));
+    return position < _size ? position : _size;
+}
+
+/**
+ * Retorna os bytes (std::size_t) usados pelos bits e pelos índices.
+ **/
+inline std::size_t structures::BitVector::bytes() const {
+    return _words.size() * sizeof(std::uint64_t) + _blocks.size() * sizeof(std::uint64_t) +
+           _zero_samples.size() * sizeof(std::uint32_t);
+}
+
+/**
+ * Retorna a quantidade de zeros (std::size_t) antes de um bloco.
+ *      Parâmetros:
+ *          block: Índice (std::size_t) do bloco.
+ **/
+inline std::size_t structures::BitVector::zeros_before(std::size_t block) const {
+    return block * WORDS_PER_BLOCK * 64 - static_cast<std::size_t>(_blocks[block]);
+}
+
+/**
+ * Constrói um objeto structures::PackedArray vazio.
+ *      Parâmetros:
+ *          max_value: Maior valor (std::uint64_t) que será guardado.
+ **/
+inline structures::PackedArray::PackedArray(std::uint64_t max_value) {
+    _size = 0;
+    _width = 0;
+    while (max_value != 0) {
+        ++_width;
+        max_value >>= 1;
+    }
+}
+
+/**
+ * Adiciona um valor no fim.
+ *      Parâmetros:
+ *          value: Valor (std::uint64_t), que cabe na largura do vetor.
+ **/
+inline void structures::PackedArray::push_back(std::uint64_t value) {
+    if (_width < 64 && (value >> _width) != 0) {
+        throw std::out_of_range("Value too large");
+    }
+
+    std::size_t bit = _size * _width;
+    std::size_t words = (bit + _width + 63) / 64;
+    if (_words.size() < words) {
+        _words.resize(words, 0);
+    }
+
+    if (_width > 0) {
+        _words[bit / 64] |= value << (bit % 64);
+        if (bit % 64 + _width > 64) {  // O valor continua na próxima palavra
+            _words[bit / 64 + 1] |= value >> (64 - bit % 64);
+        }
+    }
+    ++_size;
+}
+
+/**
+ * Retorna o valor (std::uint64_t) de uma posição.
+ *      Parâmetros:
+ *          index: Posição (std::size_t) do valor, menor que size().
+ **/
+inline std::uint64_t structures::PackedArray::operator[](std::size_t index) const {
+    if (index >= _size) {
+        throw std::out_of_range("Invalid index");
+    }
+    if (_width == 0) {
+        return 0;
+    }
+
+    std::size_t bit = index * _width;
+    std::uint64_t value = _words[bit / 64] >> (bit % 64);
+    if (bit % 64 + _width > 64) {
+        value |= _words[bit / 64 + 1] << (64 - bit % 64);
+    }
+
+    return _width == 64 ? value : value & ((std::uint64_t(1) << _width) - 1);
+}
+
+/**
+ * Retorna a quantidade de valores (std::size_t).
+ **/
+inline std::size_t structures::PackedArray::size() const {
+    return _size;
+}
+
+/**
+ * Retorna a quantidade de bits (unsigned) de cada valor.
+ **/
+inline unsigned structures::PackedArray::width() const {
+    return _width;
+}
+
+/**
+ * Retorna os bytes (std::size_t) usados pelos valores.
+ **/
+inline std::size_t structures::PackedArray::bytes() const {
+    return _words.size() * sizeof(std::uint64_t);
+}
+
+#endif
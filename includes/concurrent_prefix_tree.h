@@ -0,0 +1,637 @@
+// Copyright [2021] <Eric Fernandes Evaristo>
+// v1.0.1
+
+#ifndef STRUCTURES_CONCURRENT_PREFIX_TREE_H
+#define STRUCTURES_CONCURRENT_PREFIX_TREE_H
+
+#include <atomic>
+#include <cstdint>    // std::size_t, std::uint64_t
+#include <cstdlib>    // std::malloc, std::free
+#include <mutex>
+#include <stdexcept>  // C++ exceptions
+#include <string>
+#include <vector>
+
+#include "alphabet.h"
+#include "lookup_result.h"
+
+using std::string;
+
+namespace structures {
+
+// Classe ConcurrentPrefixTree, árvore de prefixos para muitas threads leitoras e uma escritora.
+// Os nós publicados nunca são alterados: a escrita copia o caminho da raiz até o nó alterado e
+// publica a nova raiz de forma atômica. As leituras não usam travas e terminam em uma
+// quantidade limitada de passos (wait-free). Os nós substituídos só são liberados quando
+// nenhuma leitura que poderia vê-los está ativa (recuperação por épocas). Leitoras além de
+// MAX_READERS dividem um contador e adiam as liberações enquanto lêem. O alfabeto define
+// quais bytes são letras e a quantidade máxima de filhos de um nó, como em PrefixTree
+template <typename Alphabet = LowercaseAscii>
+class ConcurrentPrefixTree {
+   public:
+    // Construtor
+    ConcurrentPrefixTree();
+    // Destrutor
+    ~ConcurrentPrefixTree();
+    // Insere um prefixo
+    void insert(const string& prefix, unsigned long position, unsigned long length);
+    // Remove um prefixo
+    void remove(const string& prefix);
+    // Verifica se contém um prefixo
+    bool contains(const string& prefix) const;
+    // Verifica se a árvore está vazia
+    bool empty() const;
+    // Retorna o tamanho da árvore
+    std::size_t size() const;
+    // Retorna o número de prefixos contidos no prefixo do parâmetro
+    unsigned long prefix_search(const string& prefix) const;
+    // Retorna a posição do prefixo
+    unsigned long position_search(const string& prefix) const;
+    // Retorna o comprimento da linha do prefixo
+    unsigned long length_search(const string& prefix) const;
+    // Retorna todos os dados do prefixo com uma única descida
+    LookupResult lookup(const string& prefix) const;
+
+    ConcurrentPrefixTree(const ConcurrentPrefixTree&) = delete;
+    ConcurrentPrefixTree& operator=(const ConcurrentPrefixTree&) = delete;
+
+    static const std::size_t MAX_READERS = 128u;  // Threads leitoras com anúncio próprio
+
+   private:
+    // Nó imutável. Os filhos e as chaves ficam logo depois do nó, na mesma alocação, que tem o
+    // tamanho exato para a capacidade do nó
+    struct Node {
+        unsigned long _position;      // Posição
+        unsigned long _length;        // Comprimento
+        unsigned long _prefix_count;  // Quantidade de prefixos contidos abaixo deste nó
+        std::uint16_t _child_count;   // Quantidade de filhos
+        std::uint16_t _capacity;      // Quantidade máxima de filhos da alocação
+
+        /**
+         * Retorna os filhos (Node**), em ordem alfabética.
+         **/
+        Node** children() { return reinterpret_cast<Node**>(this + 1); }
+        Node* const* children() const { return reinterpret_cast<Node* const*>(this + 1); }
+
+        /**
+         * Retorna os índices das letras dos filhos (unsigned char*), em ordem.
+         **/
+        unsigned char* keys() { return reinterpret_cast<unsigned char*>(children() + _capacity); }
+        const unsigned char* keys() const {
+            return reinterpret_cast<const unsigned char*>(children() + _capacity);
+        }
+
+        /**
+         * Retorna o filho de uma letra (nullptr caso não exista).
+         *      Parâmetros:
+         *          key: Índice (unsigned char) da letra.
+         **/
+        const Node* child(unsigned char key) const {
+            const unsigned char* node_keys = keys();
+            for (std::size_t i = 0; i < _child_count && node_keys[i] <= key; ++i) {
+                if (node_keys[i] == key) {
+                    return children()[i];
+                }
+            }
+
+            return nullptr;
+        }
+
+        /**
+         * Aloca um nó vazio.
+         *      Parâmetros:
+         *          capacity: Quantidade máxima (std::size_t) de filhos.
+         **/
+        static Node* allocate(std::size_t capacity) {
+            void* memory = std::malloc(sizeof(Node) + capacity * (sizeof(Node*) + 1));
+            if (memory == nullptr) {
+                throw std::out_of_range("Allocation Error");
+            }
+
+            Node* node = static_cast<Node*>(memory);
+            node->_position = 0;
+            node->_length = 0;
+            node->_prefix_count = 0;
+            node->_child_count = 0;
+            node->_capacity = static_cast<std::uint16_t>(capacity);
+            return node;
+        }
+
+        /**
+         * Cria uma cópia do nó, que pode ser alterada até ser publicada.
+         *      Parâmetros:
+         *          node: Nó (const Node*) a ser copiado.
+         *          extra: Quantidade (std::size_t) de filhos que podem ser adicionados.
+         **/
+        static Node* copy(const Node* node, std::size_t extra) {
+            Node* copied = allocate(node->_child_count + extra);
+            copied->_position = node->_position;
+            copied->_length = node->_length;
+            copied->_prefix_count = node->_prefix_count;
+            copied->_child_count = node->_child_count;
+
+            for (std::size_t i = 0; i < node->_child_count; ++i) {
+                copied->children()[i] = node->children()[i];
+                copied->keys()[i] = node->keys()[i];
+            }
+
+            return copied;
+        }
+
+        /**
+         * Define o filho de uma letra em um nó ainda não publicado. Um filho nulo remove a
+         * letra.
+         *      Parâmetros:
+         *          key: Índice (unsigned char) da letra.
+         *          child: Filho (Node*).
+         **/
+        void set_child(unsigned char key, Node* child) {
+            unsigned char* node_keys = keys();
+            Node** node_children = children();
+
+            std::size_t i = 0;
+            while (i < _child_count && node_keys[i] < key) {
+                ++i;
+            }
+
+            if (i < _child_count && node_keys[i] == key) {  // A letra já tem um filho
+                if (child != nullptr) {
+                    node_children[i] = child;
+                    return;
+                }
+
+                for (; i + 1 < _child_count; ++i) {
+                    node_keys[i] = node_keys[i + 1];
+                    node_children[i] = node_children[i + 1];
+                }
+                --_child_count;
+            } else if (child != nullptr) {  // Nova letra, as chaves maiores são empurradas
+                for (std::size_t j = _child_count; j > i; --j) {
+                    node_keys[j] = node_keys[j - 1];
+                    node_children[j] = node_children[j - 1];
+                }
+                node_keys[i] = key;
+                node_children[i] = child;
+                ++_child_count;
+            }
+        }
+
+        /**
+         * Libera o nó e todos os nós abaixo dele (recursivamente).
+         **/
+        static void destroy(Node* node) {
+            for (std::size_t i = 0; i < node->_child_count; ++i) {
+                destroy(node->children()[i]);
+            }
+
+            std::free(node);
+        }
+    };
+
+    // Nó substituído que aguarda o fim das leituras que podem vê-lo
+    struct Retired {
+        Node* node;           // Nó substituído
+        std::uint64_t epoch;  // Época em que o nó deixou de ser alcançável
+    };
+
+    // Época anunciada por uma thread leitora (0 quando a thread não está lendo). Cada anúncio
+    // ocupa uma linha de cache para que leitoras diferentes não disputem a mesma linha
+    struct alignas(64) Announcement {
+        std::atomic<std::uint64_t> epoch;
+    };
+
+    // Marca a leitura ativa da thread atual enquanto existir
+    class ReadGuard {
+       public:
+        explicit ReadGuard(const ConcurrentPrefixTree& tree);
+        ~ReadGuard();
+
+       private:
+        const ConcurrentPrefixTree& _tree;  // Árvore que está sendo lida
+        Announcement* _announcement;        // Anúncio da thread atual (nulo caso use o contador)
+    };
+
+    std::atomic<Node*> _root;                    // Raiz publicada
+    std::atomic<std::size_t> _size;              // Tamanho da árvore
+    std::atomic<std::uint64_t> _epoch;           // Época atual
+    mutable Announcement _readers[MAX_READERS];  // Anúncios das threads leitoras
+    mutable std::atomic<std::size_t> _spilled;   // Leituras ativas sem anúncio próprio
+    std::vector<Retired> _retired;               // Nós que aguardam liberação
+    std::mutex _writer;                          // Serializa as escritas
+
+    // Retorna o índice de anúncio da thread atual (MAX_READERS caso não haja um livre)
+    static std::size_t reader_index();
+    // Converte o prefixo nos índices das suas letras
+    static bool to_keys(const string& prefix, string& keys);
+    // Publica uma nova raiz e aposenta os nós substituídos
+    void publish(Node* root, Node* const* replaced, std::size_t count);
+    // Libera os nós que nenhuma leitura ativa pode ver
+    void reclaim();
+
+    static_assert(Alphabet::SIZE >= 1 && Alphabet::SIZE <= 256,
+                  "O alfabeto precisa ter de 1 a 256 letras");
+};
+
+}  // namespace structures
+
+/**
+ * Constrói um objeto structures::ConcurrentPrefixTree.
+ **/
+template <typename Alphabet>
+structures::ConcurrentPrefixTree<Alphabet>::ConcurrentPrefixTree() {
+    _root.store(Node::allocate(0));
+    _size.store(0u);
+    _epoch.store(1u);  // A época 0 indica que uma thread não está lendo
+    _spilled.store(0u);
+
+    for (std::size_t i = 0; i < MAX_READERS; ++i) {
+        _readers[i].epoch.store(0u);
+    }
+}
+
+/**
+ * Destrói o objeto structures::ConcurrentPrefixTree. Nenhuma leitura pode estar ativa.
+ **/
+template <typename Alphabet>
+structures::ConcurrentPrefixTree<Alphabet>::~ConcurrentPrefixTree() {
+    Node::destroy(_root.load());
+
+    for (const Retired& retired : _retired) {
+        std::free(retired.node);
+    }
+}
+
+/**
+ * Insere o prefixo copiando o caminho da raiz até o último caractere. Os nós do caminho antigo
+ * continuam válidos para as leituras em andamento.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) a ser inserido.
+ *          position: Posição (unsigned long) do caractere no arquivo.
+ *          length: Comprimento (unsigned long) da linha do prefixo.
+ **/
+template <typename Alphabet>
+void structures::ConcurrentPrefixTree<Alphabet>::insert(const string& prefix,
+                                                       unsigned long position,
+                                                       unsigned long length) {
+    string keys;
+    if (!to_keys(prefix, keys)) {
+        throw std::out_of_range("Invalid character");
+    }
+    if (keys.empty()) {
+        throw std::out_of_range("Empty prefix");
+    }
+
+    std::lock_guard<std::mutex> lock(_writer);
+
+    // Caminho atual: path[i] é o nó do prefixo de i letras
+    std::vector<Node*> path(1, _root.load(std::memory_order_relaxed));
+    while (path.size() <= keys.length()) {
+        const Node* child = path.back()->child(static_cast<unsigned char>(keys[path.size() - 1]));
+        if (child == nullptr) {
+            break;
+        }
+        path.push_back(const_cast<Node*>(child));
+    }
+
+    std::size_t depth = path.size() - 1;  // Comprimento do trecho que já existe
+    Node* node;                           // Nó novo mais alto construído até agora
+    std::size_t index;                    // Profundidade do nó novo mais alto
+
+    if (depth == keys.length()) {  // O nó do prefixo já existe e é copiado
+        node = Node::copy(path[depth], 0);
+        ++node->_prefix_count;
+    } else {  // Cria o nó do prefixo, que não tem filhos
+        node = Node::allocate(0);
+        node->_prefix_count = 1;
+    }
+
+    node->_position = position;
+    node->_length = length;
+
+    // Cria os nós que faltam entre o trecho existente e o nó do prefixo, de baixo para cima
+    for (index = keys.length(); index > depth + 1; --index) {
+        Node* parent = Node::allocate(1);
+        parent->_prefix_count = 1;
+        parent->set_child(static_cast<unsigned char>(keys[index - 1]), node);
+        node = parent;
+    }
+
+    // Copia os ancestrais com o novo filho e mais um prefixo contido
+    for (; index > 0; --index) {
+        // Apenas o ancestral mais baixo pode ganhar um filho novo
+        Node* parent = Node::copy(path[index - 1], index - 1 == depth ? 1 : 0);
+        parent->set_child(static_cast<unsigned char>(keys[index - 1]), node);
+        ++parent->_prefix_count;
+        node = parent;
+    }
+
+    publish(node, path.data(), path.size());
+    _size.fetch_add(1u);
+}
+
+/**
+ * Remove o prefixo copiando o caminho da raiz até o último caractere. Os nós que ficam sem
+ * prefixos não são copiados.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) a ser removido.
+ **/
+template <typename Alphabet>
+void structures::ConcurrentPrefixTree<Alphabet>::remove(const string& prefix) {
+    std::lock_guard<std::mutex> lock(_writer);
+
+    string keys;
+    if (!contains(prefix) || !to_keys(prefix, keys)) {
+        throw std::out_of_range("Prefix not found");
+    }
+
+    // Caminho completo do prefixo
+    std::vector<Node*> path(1, _root.load(std::memory_order_relaxed));
+    for (std::size_t i = 0; i < keys.length(); ++i) {
+        path.push_back(
+            const_cast<Node*>(path.back()->child(static_cast<unsigned char>(keys[i]))));
+    }
+
+    // O nó do prefixo perde os dados, ou desaparece caso não contenha outros prefixos
+    Node* node = nullptr;
+    if (path.back()->_prefix_count > 1) {
+        node = Node::copy(path.back(), 0);
+        node->_position = 0;
+        node->_length = 0;
+        --node->_prefix_count;
+    }
+
+    for (std::size_t i = keys.length(); i > 0; --i) {
+        const Node* old = path[i - 1];
+        if (i > 1 && old->_prefix_count == 1) {  // O ancestral também desaparece
+            node = nullptr;
+            continue;
+        }
+
+        Node* parent = Node::copy(old, 0);
+        parent->set_child(static_cast<unsigned char>(keys[i - 1]), node);
+        --parent->_prefix_count;
+        node = parent;
+    }
+
+    publish(node, path.data(), path.size());
+    _size.fetch_sub(1u);
+}
+
+/**
+ * Verifica se o prefixo está contido.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) a ser verificado.
+ *      Retorno (bool): valor que indica se o fim do prefixo foi encontrado ou não.
+ **/
+template <typename Alphabet>
+bool structures::ConcurrentPrefixTree<Alphabet>::contains(const string& prefix) const {
+    return lookup(prefix).found;
+}
+
+/**
+ * Retorna verdadeiro caso a árvore esteja vazia.
+ **/
+template <typename Alphabet>
+bool structures::ConcurrentPrefixTree<Alphabet>::empty() const { return size() == 0; }
+
+/**
+ * Retorna o tamanho (std::size_t).
+ **/
+template <typename Alphabet>
+std::size_t structures::ConcurrentPrefixTree<Alphabet>::size() const { return _size.load(); }
+
+/**
+ * Retorna o número de prefixos contidos em um prefixo.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) que está sendo procurado.
+ *      Retorno (unsigned long): Número de prefixos contidos em um prefixo.
+ **/
+template <typename Alphabet>
+unsigned long structures::ConcurrentPrefixTree<Alphabet>::prefix_search(
+    const string& prefix) const {
+    return lookup(prefix).prefix_count;
+}
+
+/**
+ * Retorna a posição do nó encontrado na pesquisa.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) que está sendo procurado.
+ *      Retorno (unsigned long): Posição do nó encontrado (0 caso não seja encontrado).
+ **/
+template <typename Alphabet>
+unsigned long structures::ConcurrentPrefixTree<Alphabet>::position_search(
+    const string& prefix) const {
+    return lookup(prefix).position;
+}
+
+/**
+ * Retorna o comprimento do nó encontrado na pesquisa.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) que está sendo procurado.
+ *      Retorno (unsigned long): Comprimento do nó encontrado (0 caso não seja encontrado).
+ **/
+template <typename Alphabet>
+unsigned long structures::ConcurrentPrefixTree<Alphabet>::length_search(
+    const string& prefix) const {
+    return lookup(prefix).length;
+}
+
+/**
+ * Pesquisa o prefixo na versão publicada da árvore. A leitura anuncia a época atual, desce a
+ * partir da raiz publicada e retira o anúncio, sem travas e sem repetições.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) que está sendo procurado.
+ *      Retorno (LookupResult): Quantidade de prefixos contidos, se o prefixo exato foi
+ *      encontrado, a sua posição e o seu comprimento.
+ **/
+template <typename Alphabet>
+structures::LookupResult structures::ConcurrentPrefixTree<Alphabet>::lookup(
+    const string& prefix) const {
+    LookupResult result = {0, false, 0, 0};
+
+    ReadGuard guard(*this);
+
+    // Os bytes que o alfabeto ignora são pulados e um byte fora do alfabeto encerra a descida
+    const Node* root = _root.load();
+    const Node* node = root;
+    for (std::size_t i = 0; i < prefix.length() && node != nullptr; ++i) {
+        int key = Alphabet::index(static_cast<unsigned char>(prefix[i]));
+        if (key == AlphabetIndex::SKIP) {
+            continue;
+        }
+        node = key != AlphabetIndex::INVALID ? node->child(static_cast<unsigned char>(key))
+                                             : nullptr;
+    }
+
+    if (node != nullptr && node != root) {  // O prefixo sem letras não corresponde a nenhum nó
+        result.prefix_count = node->_prefix_count;
+
+        if (node->_length != 0) {  // O nó é o fim de um prefixo
+            result.found = true;
+            result.position = node->_position;
+            result.length = node->_length;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Anuncia a época atual para a thread atual. O anúncio é feito antes da leitura da raiz, então
+ * a escritora vê a leitura antes de liberar qualquer nó que ela possa alcançar. Uma thread sem
+ * índice de anúncio incrementa o contador das leituras sem anúncio, também antes da leitura da
+ * raiz.
+ *      Parâmetros:
+ *          tree: Árvore que está sendo lida.
+ **/
+template <typename Alphabet>
+structures::ConcurrentPrefixTree<Alphabet>::ReadGuard::ReadGuard(
+    const ConcurrentPrefixTree& tree)
+    : _tree(tree) {
+    std::size_t index = reader_index();
+
+    if (index < MAX_READERS) {
+        _announcement = &tree._readers[index];
+        _announcement->epoch.store(tree._epoch.load());
+    } else {
+        _announcement = nullptr;
+        tree._spilled.fetch_add(1u);
+    }
+}
+
+/**
+ * Retira o anúncio da thread atual.
+ **/
+template <typename Alphabet>
+structures::ConcurrentPrefixTree<Alphabet>::ReadGuard::~ReadGuard() {
+    if (_announcement != nullptr) {
+        _announcement->epoch.store(0u, std::memory_order_release);
+    } else {
+        _tree._spilled.fetch_sub(1u, std::memory_order_release);
+    }
+}
+
+/**
+ * Retorna o índice de anúncio (std::size_t) da thread atual. O índice é reservado na primeira
+ * leitura da thread e devolvido quando ela termina, e vale para todas as árvores do alfabeto.
+ * Quando todos os índices estão em uso o retorno é MAX_READERS, e a reserva é tentada de novo na
+ * próxima leitura da thread.
+ **/
+template <typename Alphabet>
+std::size_t structures::ConcurrentPrefixTree<Alphabet>::reader_index() {
+    // Índices em uso, um bit por índice
+    static std::atomic<std::uint64_t> used[MAX_READERS / 64];
+
+    // Reserva de um índice que dura enquanto a thread existir
+    struct Reservation {
+        std::size_t index = MAX_READERS;
+
+        Reservation() { reserve(); }
+
+        /**
+         * Reserva o índice livre mais baixo (index fica MAX_READERS caso não haja um).
+         **/
+        void reserve() {
+            for (std::size_t word = 0; word < MAX_READERS / 64; ++word) {
+                std::uint64_t bits = used[word].load();
+                while (~bits != 0) {
+                    std::uint64_t bit = ~bits & (bits + 1);  // Bit livre mais baixo
+                    if (used[word].compare_exchange_weak(bits, bits | bit)) {
+                        index = word * 64 + __builtin_ctzll(bit);
+                        return;
+                    }
+                }
+            }
+        }
+
+        ~Reservation() {
+            if (index < MAX_READERS) {
+                used[index / 64].fetch_and(~(std::uint64_t(1) << (index % 64)));
+            }
+        }
+    };
+
+    thread_local Reservation reservation;
+    if (reservation.index == MAX_READERS) {  // Todos os índices estavam em uso
+        reservation.reserve();
+    }
+    return reservation.index;
+}
+
+/**
+ * Converte o prefixo nos índices das suas letras, pulando os bytes que o alfabeto ignora.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) a ser convertido.
+ *          keys: Índices (string&) das letras, um por caractere.
+ *      Retorno (bool): Falso caso algum caractere não pertença ao alfabeto.
+ **/
+template <typename Alphabet>
+bool structures::ConcurrentPrefixTree<Alphabet>::to_keys(const string& prefix, string& keys) {
+    keys.clear();
+
+    for (char character : prefix) {
+        int key = Alphabet::index(static_cast<unsigned char>(character));
+        if (key == AlphabetIndex::INVALID) {
+            return false;
+        }
+        if (key != AlphabetIndex::SKIP) {
+            keys.push_back(static_cast<char>(key));
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Publica uma nova raiz, aposenta os nós do caminho antigo e avança a época.
+ *      Parâmetros:
+ *          root: Nova raiz (Node*).
+ *          replaced: Nós (Node* const*) que deixaram de ser alcançáveis.
+ *          count: Quantidade (std::size_t) de nós substituídos.
+ **/
+template <typename Alphabet>
+void structures::ConcurrentPrefixTree<Alphabet>::publish(Node* root, Node* const* replaced,
+                                                         std::size_t count) {
+    _root.store(root);
+
+    std::uint64_t epoch = _epoch.load();
+    for (std::size_t i = 0; i < count; ++i) {
+        _retired.push_back({replaced[i], epoch});
+    }
+
+    _epoch.store(epoch + 1);
+    reclaim();
+}
+
+/**
+ * Libera os nós aposentados em uma época anterior à de todas as leituras ativas. Uma leitura
+ * que anunciou uma época posterior à aposentadoria leu a raiz depois da publicação, então não
+ * pode alcançar esses nós. As leituras sem anúncio não dizem a época, então nada é liberado
+ * enquanto alguma estiver ativa; os nós ficam para a próxima escrita (ou para o destrutor).
+ **/
+template <typename Alphabet>
+void structures::ConcurrentPrefixTree<Alphabet>::reclaim() {
+    if (_spilled.load() != 0) {  // Uma leitura sem anúncio pode estar em qualquer versão
+        return;
+    }
+
+    std::uint64_t oldest = _epoch.load();
+    for (std::size_t i = 0; i < MAX_READERS; ++i) {
+        std::uint64_t epoch = _readers[i].epoch.load();
+        if (epoch != 0 && epoch < oldest) {
+            oldest = epoch;
+        }
+    }
+
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < _retired.size(); ++i) {
+        if (_retired[i].epoch < oldest) {
+            std::free(_retired[i].node);
+        } else {
+            _retired[kept++] = _retired[i];
+        }
+    }
+    _retired.resize(kept);
+}
+
+#endif
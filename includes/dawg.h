@@ -0,0 +1,383 @@
+// Copyright [2021] <Eric Fernandes Evaristo>
+// v1.0.1
+
+#ifndef STRUCTURES_DAWG_H
+#define STRUCTURES_DAWG_H
+
+#include <algorithm>  // std::lower_bound
+#include <cstdint>    // std::size_t, std::uint32_t
+#include <stdexcept>  // C++ exceptions
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "alphabet.h"
+#include "lookup_result.h"
+#include "prefix_tree.h"
+
+using std::string;
+
+namespace structures {
+
+template <typename Alphabet>
+class PrefixTree;
+
+// Classe Dawg, autômato acíclico mínimo com os prefixos de uma árvore. Subárvores iguais (mesma
+// marca de fim de prefixo e mesmos filhos pelas mesmas letras) viram um único estado, então os
+// sufixos repetidos das palavras são guardados uma vez. Como um estado é compartilhado por
+// vários prefixos, a posição e o comprimento não ficam nos estados: cada prefixo recebe a sua
+// ordem alfabética (rank), somada aresta por aresta durante a descida, e os dados ficam em
+// vetores indexados por ela. O autômato é construído por PrefixTree::minimize, definida no fim
+// deste arquivo, e não muda
+template <typename Alphabet = LowercaseAscii>
+class Dawg {
+   public:
+    // Construtor padrão (nenhum prefixo)
+    Dawg();
+    // Verifica se contém um prefixo
+    bool contains(const string& prefix) const;
+    // Verifica se o autômato está vazio
+    bool empty() const;
+    // Retorna a quantidade de prefixos
+    std::size_t size() const;
+    // Retorna a quantidade de estados
+    std::size_t states() const;
+    // Retorna a quantidade de arestas
+    std::size_t edges() const;
+    // Retorna a ordem alfabética de um prefixo
+    std::size_t rank(const string& prefix) const;
+    // Retorna o número de prefixos contidos no prefixo do parâmetro
+    unsigned long prefix_search(const string& prefix) const;
+    // Retorna a posição do prefixo
+    unsigned long position_search(const string& prefix) const;
+    // Retorna o comprimento da linha do prefixo
+    unsigned long length_search(const string& prefix) const;
+    // Retorna todos os dados do prefixo com uma única descida
+    LookupResult lookup(const string& prefix) const;
+    // Retorna os bytes usados pelo autômato
+    std::size_t bytes() const;
+
+    static const std::size_t NOT_FOUND = SIZE_MAX;  // Rank de um prefixo que não existe
+
+   private:
+    template <typename>
+    friend class PrefixTree;
+
+    static const std::uint32_t NONE = UINT32_MAX;  // Estado que não existe
+
+    std::vector<std::uint32_t> _first_edge;   // Primeira aresta de cada estado (e o total no fim)
+    std::vector<unsigned char> _edge_key;     // Letra de cada aresta, em ordem em cada estado
+    std::vector<std::uint32_t> _edge_target;  // Estado de destino de cada aresta
+    std::vector<std::uint32_t> _edge_rank;    // Prefixos do estado antes do destino da aresta
+    std::vector<std::uint32_t> _count;        // Prefixos aceitos a partir de cada estado
+    std::vector<bool> _terminal;              // Indica os estados que são o fim de um prefixo
+    std::vector<unsigned long> _position;     // Posição de cada prefixo, pelo rank
+    std::vector<unsigned long> _length;       // Comprimento de cada prefixo, pelo rank
+    std::uint32_t _root;                      // Estado inicial
+
+    // Desce pelas letras de um prefixo somando o rank
+    std::uint32_t find(const string& prefix, std::size_t& rank) const;
+};
+
+}  // namespace structures
+
+/**
+ * Constrói um objeto structures::Dawg sem prefixos. Apenas o estado inicial existe.
+ **/
+template <typename Alphabet>
+structures::Dawg<Alphabet>::Dawg()
+    : _first_edge(2, 0), _count(1, 0), _terminal(1, false), _root(0) {}
+
+/**
+ * Verifica se o prefixo está no autômato.
+ *      Parâmetros:
+ *          prefix: Prefixo (string) a ser procurado.
+ *      Retorno (bool): Verdadeiro caso o prefixo exato exista.
+ **/
+template <typename Alphabet>
+bool structures::Dawg<Alphabet>::contains(const string& prefix) const {
+    return rank(prefix) != NOT_FOUND;
+}
+
+/**
+ * Retorna verdadeiro caso o autômato não tenha prefixos.
+ **/
+template <typename Alphabet>
+bool structures::Dawg<Alphabet>::empty() const {
+    return _position.empty();
+}
+
+/**
+ * Retorna a quantidade de prefixos (std::size_t).
+ **/
+template <typename Alphabet>
+std::size_t structures::Dawg<Alphabet>::size() const {
+    return _position.size();
+}
+
+/**
+ * Retorna a quantidade de estados (std::size_t), incluindo o inicial.
+ **/
+template <typename Alphabet>
+std::size_t structures::Dawg<Alphabet>::states() const {
+    return _count.size();
+}
+
+/**
+ * Retorna a quantidade de arestas (std::size_t).
+ **/
+template <typename Alphabet>
+std::size_t structures::Dawg<Alphabet>::edges() const {
+    return _edge_key.size();
+}
+
+/**
+ * Retorna a ordem alfabética de um prefixo entre todos os prefixos do autômato.
+ *      Parâmetros:
+ *          prefix: Prefixo (string) a ser procurado.
+ *      Retorno (std::size_t): Rank a partir de 0 (NOT_FOUND caso o prefixo exato não exista).
+ **/
+template <typename Alphabet>
+std::size_t structures::Dawg<Alphabet>::rank(const string& prefix) const {
+    std::size_t rank;
+    std::uint32_t state = find(prefix, rank);
+
+    return state != NONE && state != _root && _terminal[state] ? rank : NOT_FOUND;
+}
+
+/**
+ * Retorna o número de prefixos contidos no prefixo do parâmetro.
+ *      Parâmetros:
+ *          prefix: Prefixo (string) a ser pesquisado.
+ *      Retorno (unsigned long): Quantidade de prefixos (0 caso o caminho não exista).
+ **/
+template <typename Alphabet>
+unsigned long structures::Dawg<Alphabet>::prefix_search(const string& prefix) const {
+    return lookup(prefix).prefix_count;
+}
+
+/**
+ * Retorna a posição do prefixo.
+ *      Parâmetros:
+ *          prefix: Prefixo (string) a ser pesquisado.
+ *      Retorno (unsigned long): Posição (0 caso o prefixo não exista).
+ **/
+template <typename Alphabet>
+unsigned long structures::Dawg<Alphabet>::position_search(const string& prefix) const {
+    return lookup(prefix).position;
+}
+
+/**
+ * Retorna o comprimento da linha do prefixo.
+ *      Parâmetros:
+ *          prefix: Prefixo (string) a ser pesquisado.
+ *      Retorno (unsigned long): Comprimento (0 caso o prefixo não exista).
+ **/
+template <typename Alphabet>
+unsigned long structures::Dawg<Alphabet>::length_search(const string& prefix) const {
+    return lookup(prefix).length;
+}
+
+/**
+ * Retorna todos os dados do prefixo com uma única descida. A contagem é a do estado e a posição
+ * e o comprimento ficam no rank do prefixo.
+ *      Parâmetros:
+ *          prefix: Prefixo (string) a ser pesquisado.
+ *      Retorno (LookupResult): Contagem, existência, posição e comprimento do prefixo.
+ **/
+template <typename Alphabet>
+structures::LookupResult structures::Dawg<Alphabet>::lookup(const string& prefix) const {
+    LookupResult result = {0, false, 0, 0};
+    std::size_t rank;
+
+    std::uint32_t state = find(prefix, rank);
+    if (state == NONE || state == _root) {  // O prefixo vazio não corresponde a nenhum estado
+        return result;
+    }
+
+    result.prefix_count = _count[state];
+
+    if (_terminal[state]) {  // O estado é o fim de um prefixo
+        result.found = true;
+        result.position = _position[rank];
+        result.length = _length[rank];
+    }
+
+    return result;
+}
+
+/**
+ * Retorna os bytes (std::size_t) usados pelos vetores do autômato.
+ **/
+template <typename Alphabet>
+std::size_t structures::Dawg<Alphabet>::bytes() const {
+    return sizeof(*this) + _first_edge.capacity() * sizeof(std::uint32_t) +
+           _edge_key.capacity() * sizeof(unsigned char) +
+           (_edge_target.capacity() + _edge_rank.capacity() + _count.capacity()) *
+               sizeof(std::uint32_t) +
+           _terminal.capacity() / 8 +
+           (_position.capacity() + _length.capacity()) * sizeof(unsigned long);
+}
+
+/**
+ * Desce pelas letras de um prefixo. O rank de cada aresta é a quantidade de prefixos do estado
+ * que vêm antes do destino dela (os que terminam no próprio estado e os das subárvores das
+ * letras menores), então a soma dos ranks do caminho é a ordem alfabética do prefixo.
+ *      Parâmetros:
+ *          prefix: Prefixo (string) a ser procurado.
+ *          rank: Soma (std::size_t&) dos ranks das arestas do caminho, escrita pela função.
+ *      Retorno (std::uint32_t): Estado do prefixo (o inicial caso ele não tenha letras, NONE
+ *          caso não exista).
+ **/
+template <typename Alphabet>
+std::uint32_t structures::Dawg<Alphabet>::find(const string& prefix, std::size_t& rank) const {
+    std::uint32_t state = _root;
+    rank = 0;
+
+    for (char character : prefix) {
+        int key = Alphabet::index(static_cast<unsigned char>(character));
+
+        if (key == AlphabetIndex::SKIP) {
+            continue;
+        }
+        if (key == AlphabetIndex::INVALID) {
+            return NONE;
+        }
+
+        auto begin = _edge_key.begin() + _first_edge[state];
+        auto end = _edge_key.begin() + _first_edge[state + 1];
+        auto it = std::lower_bound(begin, end, static_cast<unsigned char>(key));
+        if (it == end || *it != key) {  // Não existe a transição
+            return NONE;
+        }
+
+        std::size_t edge = static_cast<std::size_t>(it - _edge_key.begin());
+        rank += _edge_rank[edge];
+        state = _edge_target[edge];
+    }
+
+    return state;
+}
+
+/**
+ * Converte a árvore em um autômato acíclico mínimo. Os nós são colocados em uma fila em largura,
+ * onde os filhos de cada nó ficam juntos, e o rank de cada nó é calculado a partir do pai com as
+ * contagens dos irmãos de letra menor. Depois a fila é percorrida de trás para frente, então os
+ * filhos de um nó já têm estado quando ele é visitado: a assinatura do nó (marca de fim de
+ * prefixo, prefixos que terminam nele e pares de letra e estado dos filhos) é procurada em uma
+ * tabela e um novo estado só é criado quando ela não existe. Um prefixo inserido mais de uma vez
+ * ocupa um rank por inserção, como na contagem da árvore, e os dados ficam no primeiro.
+ *      Retorno (Dawg<Alphabet>): Autômato com os mesmos prefixos.
+ **/
+template <typename Alphabet>
+structures::Dawg<Alphabet> structures::PrefixTree<Alphabet>::minimize() const {
+    if (_pool.size() >= UINT32_MAX) {  // Os estados são índices de 32 bits
+        throw std::out_of_range("Tree too large");
+    }
+
+    // Nó da fila da busca em largura (nulo representa a raiz)
+    struct Queued {
+        const Node* node;   // Nó da árvore
+        unsigned char key;  // Letra do nó
+        std::size_t first;  // Primeiro filho na fila
+        std::size_t count;  // Quantidade de filhos
+        std::size_t rank;   // Ordem alfabética do prefixo do nó
+        std::size_t own;    // Prefixos que terminam no nó (mais de um caso tenha sido repetido)
+    };
+
+    Dawg<Alphabet> dawg;
+    dawg._position.resize(_size);
+    dawg._length.resize(_size);
+
+    std::vector<Queued> queue;
+    queue.reserve(_pool.size() + 1);
+    queue.push_back({nullptr, 0, 0, 0, 0, 0});
+
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        const Node* node = queue[head].node;
+        std::size_t rank = queue[head].rank;
+
+        // A contagem do nó menos as dos filhos são os prefixos que terminam nele
+        if (node != nullptr) {
+            std::size_t own = node->prefix_count();
+            node->for_each_child([&](unsigned char, const Node* child) {
+                own -= child->prefix_count();
+            });
+            queue[head].own = own;
+
+            if (node->length() != 0) {
+                dawg._position[rank] = node->position();
+                dawg._length[rank] = node->length();
+            }
+            rank += own;
+        }
+
+        // Cada filho vem depois do nó e dos filhos de letra menor
+        auto add = [&](unsigned char key, const Node* child) {
+            queue.push_back({child, key, 0, 0, rank, 0});
+            rank += child->prefix_count();
+        };
+
+        queue[head].first = queue.size();
+        if (node == nullptr) {
+            for (std::size_t i = 0; i < Alphabet::SIZE; ++i) {
+                if (_root[i] != nullptr) {
+                    add(static_cast<unsigned char>(i), _root[i]);
+                }
+            }
+        } else {
+            node->for_each_child(add);
+        }
+        queue[head].count = queue.size() - queue[head].first;
+    }
+
+    dawg._first_edge.assign(1, 0);
+    dawg._count.clear();
+    dawg._terminal.clear();
+
+    std::vector<std::uint32_t> states(queue.size());       // Estado de cada nó da fila
+    std::unordered_map<string, std::uint32_t> signatures;  // Estado de cada assinatura
+    signatures.reserve(queue.size());
+    string signature;
+
+    for (std::size_t head = queue.size(); head-- > 0;) {
+        const Queued& entry = queue[head];
+        bool terminal = entry.node != nullptr && entry.node->length() != 0;
+        std::uint32_t own = static_cast<std::uint32_t>(entry.own);
+
+        signature.assign(1, terminal ? '1' : '0');
+        signature.append(reinterpret_cast<const char*>(&own), sizeof(std::uint32_t));
+        for (std::size_t i = entry.first; i < entry.first + entry.count; ++i) {
+            signature.push_back(static_cast<char>(queue[i].key));
+            signature.append(reinterpret_cast<const char*>(&states[i]), sizeof(std::uint32_t));
+        }
+
+        auto found = signatures.find(signature);
+        if (found != signatures.end()) {  // Uma subárvore igual já tem estado
+            states[head] = found->second;
+            continue;
+        }
+
+        std::uint32_t state = static_cast<std::uint32_t>(dawg._count.size());
+        std::uint32_t before = own;  // Prefixos do estado antes do próximo filho
+
+        for (std::size_t i = entry.first; i < entry.first + entry.count; ++i) {
+            dawg._edge_key.push_back(queue[i].key);
+            dawg._edge_target.push_back(states[i]);
+            dawg._edge_rank.push_back(before);
+            before += static_cast<std::uint32_t>(queue[i].node->prefix_count());
+        }
+
+        dawg._first_edge.push_back(static_cast<std::uint32_t>(dawg._edge_key.size()));
+        dawg._count.push_back(before);
+        dawg._terminal.push_back(terminal);
+
+        states[head] = state;
+        signatures.emplace(signature, state);
+    }
+
+    dawg._root = states[0];
+    return dawg;
+}
+
+#endif
@@ -0,0 +1,288 @@
+// Copyright [2021] <Eric Fernandes Evaristo>
+// v1.0.1
+
+#ifndef STRUCTURES_DICTIONARY_H
+#define STRUCTURES_DICTIONARY_H
+
+#include <fcntl.h>     // open
+#include <sys/mman.h>  // mmap, munmap
+#include <sys/stat.h>  // fstat
+#include <unistd.h>    // close
+
+#include <cstdint>      // std::size_t, std::int16_t
+#include <stdexcept>    // C++ exceptions
+#include <string>
+#include <string_view>  // std::string_view
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>  // Busca vetorial de 32 bytes
+#elif defined(__SSE2__)
+#include <emmintrin.h>  // Busca vetorial de 16 bytes
+#endif
+
+#include "alphabet.h"
+#include "lookup_result.h"
+#include "prefix_tree.h"
+
+using std::string;
+
+namespace structures {
+
+// Classe Dictionary, dicionário que mantém o arquivo .dic mapeado na memória. A árvore de
+// prefixos guarda a posição e o comprimento da linha de cada palavra, então a definição é
+// devolvida como uma visão sobre o arquivo mapeado, sem leitura nem cópia. O alfabeto define
+// quais caracteres formam as palavras
+template <typename Alphabet = LowercaseAscii>
+class Dictionary {
+   public:
+    // Construtor
+    explicit Dictionary(const string& filename);
+    // Destrutor
+    ~Dictionary();
+    // Retorna a linha da palavra no arquivo (vazia caso a palavra não exista)
+    std::string_view definition(const string& word) const;
+    // Retorna o trecho do arquivo de uma posição e um comprimento
+    std::string_view entry(unsigned long position, unsigned long length) const;
+    // Retorna todos os dados do prefixo com uma única descida na árvore
+    LookupResult lookup(const string& prefix) const;
+    // Retorna a árvore de prefixos do dicionário
+    const PrefixTree<Alphabet>& tree() const;
+    // Retorna o conteúdo inteiro do arquivo
+    std::string_view text() const;
+
+    Dictionary(const Dictionary&) = delete;
+    Dictionary& operator=(const Dictionary&) = delete;
+
+   private:
+    const char* _text;           // Arquivo mapeado (nulo caso o arquivo esteja vazio)
+    std::size_t _length;         // Tamanho do arquivo
+    PrefixTree<Alphabet> _tree;  // Árvore com as palavras do arquivo
+
+    // Separa as palavras das linhas do arquivo mapeado
+    std::vector<typename PrefixTree<Alphabet>::EntryView> parse() const;
+    // Procura a próxima quebra de linha
+    static const char* find_newline(const char* begin, const char* end);
+};
+
+}  // namespace structures
+
+/**
+ * Constrói um objeto structures::Dictionary. O arquivo é mapeado na memória e a árvore é
+ * construída a partir das linhas dele.
+ *      Parâmetros:
+ *          filename: Nome (string) do arquivo .dic.
+ **/
+template <typename Alphabet>
+inline structures::Dictionary<Alphabet>::Dictionary(const string& filename) {
+    _text = nullptr;
+    _length = 0u;
+
+    int descriptor = open(filename.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        throw std::out_of_range("File not found");
+    }
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0) {
+        close(descriptor);
+        throw std::out_of_range("File not found");
+    }
+
+    // Um arquivo vazio não pode ser mapeado, e também não tem palavras
+    if (status.st_size > 0) {
+        std::size_t size = static_cast<std::size_t>(status.st_size);
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0);
+
+        if (mapping == MAP_FAILED) {
+            close(descriptor);
+            throw std::out_of_range("Allocation Error");
+        }
+
+        _text = static_cast<const char*>(mapping);
+        _length = size;
+    }
+
+    close(descriptor);  // O mapeamento continua válido sem o descritor
+
+    try {
+        // As palavras são visões sobre o arquivo mapeado, que existe durante toda a construção
+        std::vector<typename PrefixTree<Alphabet>::EntryView> entries = parse();
+        _tree.build_parallel(entries.begin(), entries.end());
+    } catch (...) {
+        if (_text != nullptr) {
+            munmap(const_cast<char*>(_text), _length);
+        }
+        throw;
+    }
+}
+
+/**
+ * Destrói o objeto structures::Dictionary. As visões entregues deixam de ser válidas.
+ **/
+template <typename Alphabet>
+inline structures::Dictionary<Alphabet>::~Dictionary() {
+    if (_text != nullptr) {
+        munmap(const_cast<char*>(_text), _length);
+    }
+}
+
+/**
+ * Separa as palavras das linhas do arquivo mapeado. A palavra de cada linha são os caracteres
+ * do alfabeto logo depois do primeiro caractere, até um ']' ou um caractere fora do alfabeto. A
+ * posição é a do início da linha e o comprimento é o da linha sem a quebra. Só a palavra é
+ * percorrida caractere por caractere, o resto da linha é pulado pela busca vetorial da quebra
+ * de linha. Linhas cuja palavra não tem nenhuma letra são ignoradas.
+ *      Retorno (std::vector<EntryView>): Palavras na ordem do arquivo.
+ **/
+template <typename Alphabet>
+inline std::vector<typename structures::PrefixTree<Alphabet>::EntryView>
+structures::Dictionary<Alphabet>::parse() const {
+    std::vector<typename PrefixTree<Alphabet>::EntryView> entries;
+    const char* end = _text + _length;
+    const char* line = _text;  // Início da linha
+
+    if (_text != nullptr) {
+        // O arquivo é lido uma única vez do início ao fim
+        madvise(const_cast<char*>(_text), _length, MADV_SEQUENTIAL);
+    }
+
+    while (line < end) {
+        // A palavra começa depois do primeiro caractere e termina no ']' ou no primeiro
+        // caractere fora do alfabeto. Uma linha vazia não tem primeiro caractere
+        const char* word = *line != '\n' ? line + 1 : line;
+        const char* cursor = word;
+        bool letter = false;  // Indica se a palavra tem alguma letra além dos bytes ignorados
+        while (cursor < end && *cursor != '\n' && *cursor != ']') {
+            std::int16_t key = Alphabet::index(static_cast<unsigned char>(*cursor));
+            if (key == AlphabetIndex::INVALID) {
+                break;
+            }
+            letter = letter || key != AlphabetIndex::SKIP;
+            ++cursor;
+        }
+
+        const char* newline = find_newline(cursor, end);
+
+        // Linhas sem palavra (vazias ou que não começam com uma letra) não entram na árvore
+        if (letter) {
+            entries.push_back({std::string_view(word, cursor - word),
+                               static_cast<unsigned long>(line - _text),
+                               static_cast<unsigned long>(newline - line)});
+        }
+        line = newline + 1;
+    }
+
+    if (_text != nullptr) {
+        // As definições são lidas em posições aleatórias depois da construção
+        madvise(const_cast<char*>(_text), _length, MADV_RANDOM);
+    }
+
+    return entries;
+}
+
+/**
+ * Procura a próxima quebra de linha comparando 32 bytes de uma vez com AVX2, ou 16 bytes com
+ * SSE2, e termina os bytes restantes um por um.
+ *      Parâmetros:
+ *          begin: Início (const char*) da busca.
+ *          end: Fim (const char*) do texto.
+ *      Retorno (const char*): Quebra de linha encontrada (end caso não exista).
+ **/
+template <typename Alphabet>
+inline const char* structures::Dictionary<Alphabet>::find_newline(const char* begin,
+                                                                  const char* end) {
+#if defined(__AVX2__)
+    const __m256i newline = _mm256_set1_epi8('\n');
+    while (end - begin >= 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, newline));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 32;
+    }
+#elif defined(__SSE2__)
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (end - begin >= 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 16;
+    }
+#endif
+
+    while (begin < end && *begin != '\n') {
+        ++begin;
+    }
+
+    return begin;
+}
+
+/**
+ * Retorna a linha da palavra no arquivo. A visão aponta para o arquivo mapeado e continua válida
+ * enquanto o dicionário existir.
+ *      Parâmetros:
+ *          word: Palavra (string) que está sendo procurada.
+ *      Retorno (std::string_view): Linha da palavra (vazia caso a palavra não exista).
+ **/
+template <typename Alphabet>
+inline std::string_view structures::Dictionary<Alphabet>::definition(const string& word) const {
+    LookupResult result = _tree.lookup(word);
+
+    if (!result.found) {
+        return std::string_view();
+    }
+
+    return entry(result.position, result.length);
+}
+
+/**
+ * Retorna o trecho do arquivo de uma posição e um comprimento, como os devolvidos por
+ * position_search e length_search.
+ *      Parâmetros:
+ *          position: Posição (unsigned long) do início do trecho.
+ *          length: Comprimento (unsigned long) do trecho.
+ *      Retorno (std::string_view): Trecho do arquivo mapeado.
+ **/
+template <typename Alphabet>
+inline std::string_view structures::Dictionary<Alphabet>::entry(unsigned long position,
+                                                                unsigned long length) const {
+    if (position > _length || length > _length - position) {
+        throw std::out_of_range("Invalid entry");
+    }
+
+    return std::string_view(_text + position, length);
+}
+
+/**
+ * Retorna todos os dados do prefixo com uma única descida na árvore.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) que está sendo procurado.
+ *      Retorno (LookupResult): Dados do prefixo.
+ **/
+template <typename Alphabet>
+inline structures::LookupResult structures::Dictionary<Alphabet>::lookup(
+    const string& prefix) const {
+    return _tree.lookup(prefix);
+}
+
+/**
+ * Retorna a árvore de prefixos (const PrefixTree<Alphabet>&) do dicionário.
+ **/
+template <typename Alphabet>
+inline const structures::PrefixTree<Alphabet>& structures::Dictionary<Alphabet>::tree() const {
+    return _tree;
+}
+
+/**
+ * Retorna o conteúdo inteiro do arquivo (std::string_view).
+ **/
+template <typename Alphabet>
+inline std::string_view structures::Dictionary<Alphabet>::text() const {
+    return std::string_view(_text, _length);
+}
+
+#endif
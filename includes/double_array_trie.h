@@ -0,0 +1,713 @@
+// Copyright [2021] <Eric Fernandes Evaristo>
+// v1.0.1
+
+#ifndef STRUCTURES_DOUBLE_ARRAY_TRIE_H
+#define STRUCTURES_DOUBLE_ARRAY_TRIE_H
+
+#include <fcntl.h>     // open
+#include <sys/mman.h>  // mmap, munmap
+#include <sys/stat.h>  // fstat
+#include <unistd.h>    // close
+
+#include <cstdint>    // std::size_t, std::int32_t, std::uint64_t
+#include <cstring>    // std::memcmp, std::memcpy, std::memset
+#include <fstream>
+#include <stdexcept>  // C++ exceptions
+#include <string>
+
+#include "alphabet.h"
+#include "lookup_result.h"
+#include "prefix_tree.h"
+
+using std::string;
+
+namespace structures {
+
+template <typename Alphabet>
+class PrefixTree;
+
+// Classe DoubleArrayTrie, árvore de prefixos imutável em vetor duplo (BASE/CHECK). Cada estado
+// é um índice e a transição pela letra c leva ao estado t = BASE[s] + c, que só é válido se
+// CHECK[t] == s. As contagens, posições e comprimentos ficam em vetores paralelos. A árvore
+// guarda a tabela do alfabeto da árvore de origem, que converte os bytes das pesquisas nas
+// letras. A árvore é construída por PrefixTree::freeze, definida no fim deste arquivo
+class DoubleArrayTrie {
+   public:
+    // Construtor padrão (árvore vazia)
+    DoubleArrayTrie();
+    // Construtor de movimento
+    DoubleArrayTrie(DoubleArrayTrie&& other);
+    // Destrutor
+    ~DoubleArrayTrie();
+    // Atribuição de movimento
+    DoubleArrayTrie& operator=(DoubleArrayTrie&& other);
+    // Verifica se contém um prefixo
+    bool contains(const string& prefix) const;
+    // Verifica se a árvore está vazia
+    bool empty() const;
+    // Retorna o tamanho da árvore
+    std::size_t size() const;
+    // Retorna a quantidade de estados dos vetores
+    std::size_t capacity() const;
+    // Retorna o número de prefixos contidos no prefixo do parâmetro
+    unsigned long prefix_search(const string& prefix) const;
+    // Retorna a posição do prefixo
+    unsigned long position_search(const string& prefix) const;
+    // Retorna o comprimento da linha do prefixo
+    unsigned long length_search(const string& prefix) const;
+    // Retorna todos os dados do prefixo com uma única descida
+    LookupResult lookup(const string& prefix) const;
+    // Grava a árvore em um arquivo de índice
+    void save(const string& filename) const;
+    // Mapeia um arquivo de índice na memória
+    static DoubleArrayTrie load(const string& filename, bool verify = true);
+    // Verifica se o arquivo é um arquivo de índice
+    static bool is_index(const string& filename);
+
+    DoubleArrayTrie(const DoubleArrayTrie&) = delete;
+    DoubleArrayTrie& operator=(const DoubleArrayTrie&) = delete;
+
+   private:
+    template <typename Alphabet>
+    friend class PrefixTree;
+
+    // Cabeçalho do arquivo de índice. Os vetores são gravados depois dele, alinhados a 8 bytes,
+    // e são localizados por deslocamentos relativos ao início do arquivo
+    struct IndexHeader {
+        char magic[8];                       // Identificação do formato
+        std::uint32_t version;               // Versão do formato
+        std::uint32_t byte_order;            // Marca para detectar outra ordem de bytes
+        std::uint64_t capacity;              // Quantidade de estados
+        std::uint64_t size;                  // Quantidade de prefixos
+        std::uint64_t base_offset;           // Deslocamento do vetor BASE
+        std::uint64_t check_offset;          // Deslocamento do vetor CHECK
+        std::uint64_t prefix_count_offset;   // Deslocamento das contagens
+        std::uint64_t position_offset;       // Deslocamento das posições
+        std::uint64_t length_offset;         // Deslocamento dos comprimentos
+        std::uint64_t file_size;             // Tamanho total do arquivo
+        std::uint64_t checksum;              // FNV-1a do arquivo, com este campo zerado
+        AlphabetTable table;                 // Tabela do alfabeto
+    };
+
+    std::int32_t* _base;            // Deslocamento dos filhos de cada estado
+    std::int32_t* _check;           // Pai de cada estado (-1 caso o estado esteja livre)
+    std::uint64_t* _prefix_count;   // Quantidade de prefixos contidos abaixo de cada estado
+    std::uint64_t* _position;       // Posição de cada estado
+    std::uint64_t* _length;         // Comprimento de cada estado
+    std::size_t _capacity;          // Quantidade de estados dos vetores
+    std::size_t _size;              // Quantidade de prefixos
+    std::size_t _first_free;        // Primeiro estado livre (usado apenas na construção)
+    void* _mapping;                 // Arquivo mapeado (nulo caso os vetores sejam próprios)
+    std::size_t _mapping_size;      // Tamanho do arquivo mapeado
+    AlphabetTable _table;           // Índice da letra de cada byte, ou um valor de AlphabetIndex
+    // Aumenta os vetores
+    void grow(std::size_t capacity);
+    // Escolhe a base dos filhos de um estado e reserva os estados dos filhos
+    std::int32_t place(std::int32_t state, const unsigned char* keys, std::size_t count);
+    // Libera os vetores
+    void release();
+    // Acumula bytes no checksum FNV-1a
+    static std::uint64_t checksum(std::uint64_t hash, const void* data, std::size_t size);
+    // Retorna o checksum FNV-1a do cabeçalho, com o campo do checksum zerado
+    static std::uint64_t checksum(const IndexHeader& header);
+
+    static const std::int32_t INITIAL_CAPACITY = 27;  // Tamanho inicial, aumentado por grow
+    static const std::uint32_t INDEX_VERSION = 3u;
+    static const std::uint32_t BYTE_ORDER_MARK = 0x01020304u;
+    static const std::uint64_t FNV_OFFSET = 14695981039346656037ull;
+};
+
+}  // namespace structures
+
+/**
+ * Constrói um objeto structures::DoubleArrayTrie vazio, com o alfabeto LowercaseAscii. Apenas o
+ * estado da raiz existe.
+ **/
+inline structures::DoubleArrayTrie::DoubleArrayTrie() {
+    _base = nullptr;
+    _check = nullptr;
+    _prefix_count = nullptr;
+    _position = nullptr;
+    _length = nullptr;
+    _capacity = 0u;
+    _size = 0u;
+    _first_free = 1u;
+    _mapping = nullptr;
+    _mapping_size = 0u;
+    _table = LowercaseAscii::TABLE;
+
+    grow(INITIAL_CAPACITY);
+    _check[0] = 0;  // A raiz é o seu próprio pai
+}
+
+/**
+ * Constrói um objeto structures::DoubleArrayTrie tomando os vetores de outro.
+ *      Parâmetros:
+ *          other (DoubleArrayTrie&&): Árvore que perde os vetores.
+ **/
+inline structures::DoubleArrayTrie::DoubleArrayTrie(DoubleArrayTrie&& other) {
+    _base = other._base;
+    _check = other._check;
+    _prefix_count = other._prefix_count;
+    _position = other._position;
+    _length = other._length;
+    _capacity = other._capacity;
+    _size = other._size;
+    _first_free = other._first_free;
+    _mapping = other._mapping;
+    _mapping_size = other._mapping_size;
+    _table = other._table;
+
+    other._base = nullptr;
+    other._check = nullptr;
+    other._prefix_count = nullptr;
+    other._position = nullptr;
+    other._length = nullptr;
+    other._capacity = 0u;
+    other._size = 0u;
+    other._mapping = nullptr;
+    other._mapping_size = 0u;
+}
+
+/**
+ * Destrói o objeto structures::DoubleArrayTrie.
+ **/
+inline structures::DoubleArrayTrie::~DoubleArrayTrie() {
+    release();
+}
+
+/**
+ * Toma os vetores de outra árvore.
+ *      Parâmetros:
+ *          other (DoubleArrayTrie&&): Árvore que perde os vetores.
+ **/
+inline structures::DoubleArrayTrie& structures::DoubleArrayTrie::operator=(
+    DoubleArrayTrie&& other) {
+    if (this != &other) {
+        release();
+
+        _base = other._base;
+        _check = other._check;
+        _prefix_count = other._prefix_count;
+        _position = other._position;
+        _length = other._length;
+        _capacity = other._capacity;
+        _size = other._size;
+        _first_free = other._first_free;
+        _mapping = other._mapping;
+        _mapping_size = other._mapping_size;
+        _table = other._table;
+
+        other._base = nullptr;
+        other._check = nullptr;
+        other._prefix_count = nullptr;
+        other._position = nullptr;
+        other._length = nullptr;
+        other._capacity = 0u;
+        other._size = 0u;
+        other._mapping = nullptr;
+        other._mapping_size = 0u;
+    }
+
+    return *this;
+}
+
+/**
+ * Verifica se o prefixo está contido.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) a ser verificado.
+ *      Retorno (bool): valor que indica se o fim do prefixo foi encontrado ou não.
+ **/
+inline bool structures::DoubleArrayTrie::contains(const string& prefix) const {
+    return lookup(prefix).found;
+}
+
+/**
+ * Retorna verdadeiro caso a árvore esteja vazia.
+ **/
+inline bool structures::DoubleArrayTrie::empty() const { return size() == 0; }
+
+/**
+ * Retorna o tamanho (std::size_t).
+ **/
+inline std::size_t structures::DoubleArrayTrie::size() const { return _size; }
+
+/**
+ * Retorna a quantidade de estados dos vetores (std::size_t), incluindo os livres.
+ **/
+inline std::size_t structures::DoubleArrayTrie::capacity() const { return _capacity; }
+
+/**
+ * Retorna o número de prefixos contidos em um prefixo.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) que está sendo procurado.
+ *      Retorno (unsigned long): Número de prefixos contidos em um prefixo.
+ **/
+inline unsigned long structures::DoubleArrayTrie::prefix_search(const string& prefix) const {
+    return lookup(prefix).prefix_count;
+}
+
+/**
+ * Retorna a posição do estado encontrado na pesquisa.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) que está sendo procurado.
+ *      Retorno (unsigned long): Posição do estado encontrado (0 caso não seja encontrado).
+ **/
+inline unsigned long structures::DoubleArrayTrie::position_search(const string& prefix) const {
+    return lookup(prefix).position;
+}
+
+/**
+ * Retorna o comprimento do estado encontrado na pesquisa.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) que está sendo procurado.
+ *      Retorno (unsigned long): Comprimento do estado encontrado (0 caso não seja encontrado).
+ **/
+inline unsigned long structures::DoubleArrayTrie::length_search(const string& prefix) const {
+    return lookup(prefix).length;
+}
+
+/**
+ * Pesquisa o prefixo. Cada letra custa duas leituras de vetor (BASE e CHECK). Os bytes que o
+ * alfabeto ignora são pulados e um byte fora do alfabeto encerra a pesquisa.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) que está sendo procurado.
+ *      Retorno (LookupResult): Quantidade de prefixos contidos, se o prefixo exato foi
+ *      encontrado, a sua posição e o seu comprimento.
+ **/
+inline structures::LookupResult structures::DoubleArrayTrie::lookup(const string& prefix) const {
+    LookupResult result = {0, false, 0, 0};
+
+    std::int32_t state = 0;
+    for (std::size_t i = 0; i < prefix.length(); ++i) {
+        std::int32_t key = _table[static_cast<unsigned char>(prefix[i])];
+        if (key == AlphabetIndex::SKIP) {
+            continue;
+        }
+        if (key == AlphabetIndex::INVALID) {  // O caractere não faz parte do alfabeto
+            return result;
+        }
+
+        // O código da letra é o índice mais 1, para que nenhuma transição leve de volta à raiz
+        std::int32_t c = key + 1;
+
+        // A soma é feita em 64 bits, então uma base inválida de um arquivo não transborda
+        std::int64_t next = static_cast<std::int64_t>(_base[state]) + c;
+        if (next < 0 || static_cast<std::uint64_t>(next) >= _capacity ||
+            _check[next] != state) {  // Não existe a transição
+            return result;
+        }
+
+        state = static_cast<std::int32_t>(next);
+    }
+
+    if (state == 0) {  // O prefixo sem letras não corresponde a nenhum estado
+        return result;
+    }
+
+    result.prefix_count = _prefix_count[state];
+
+    if (_length[state] != 0) {  // O estado é o fim de um prefixo
+        result.found = true;
+        result.position = _position[state];
+        result.length = _length[state];
+    }
+
+    return result;
+}
+
+/**
+ * Aumenta os vetores para a nova quantidade de estados. Os novos estados ficam livres.
+ *      Parâmetros:
+ *          capacity (std::size_t): Nova quantidade de estados.
+ **/
+inline void structures::DoubleArrayTrie::grow(std::size_t capacity) {
+    std::int32_t* base = new std::int32_t[capacity];
+    std::int32_t* check = new std::int32_t[capacity];
+    std::uint64_t* prefix_count = new std::uint64_t[capacity];
+    std::uint64_t* position = new std::uint64_t[capacity];
+    std::uint64_t* length = new std::uint64_t[capacity];
+
+    for (std::size_t i = 0; i < capacity; ++i) {
+        if (i < _capacity) {
+            base[i] = _base[i];
+            check[i] = _check[i];
+            prefix_count[i] = _prefix_count[i];
+            position[i] = _position[i];
+            length[i] = _length[i];
+        } else {
+            base[i] = 0;
+            check[i] = -1;
+            prefix_count[i] = 0;
+            position[i] = 0;
+            length[i] = 0;
+        }
+    }
+
+    delete[] _base;
+    delete[] _check;
+    delete[] _prefix_count;
+    delete[] _position;
+    delete[] _length;
+
+    _base = base;
+    _check = check;
+    _prefix_count = prefix_count;
+    _position = position;
+    _length = length;
+    _capacity = capacity;
+}
+
+/**
+ * Escolhe a menor base em que todos os filhos do estado caem em estados livres e reserva esses
+ * estados. A procura começa no primeiro estado livre, que avança conforme os vetores enchem.
+ *      Parâmetros:
+ *          state (std::int32_t): Estado pai.
+ *          keys (const unsigned char*): Índices das letras dos filhos, em ordem.
+ *          count (std::size_t): Quantidade de filhos.
+ *      Retorno (std::int32_t): Base escolhida.
+ **/
+inline std::int32_t structures::DoubleArrayTrie::place(std::int32_t state,
+                                                       const unsigned char* keys,
+                                                       std::size_t count) {
+    // Avança o primeiro estado livre sobre os estados já ocupados
+    while (_first_free < _capacity && _check[_first_free] != -1) {
+        ++_first_free;
+    }
+
+    std::int32_t first = keys[0] + 1;
+    std::size_t position = _first_free;
+    std::int32_t base;
+
+    while (true) {
+        // A base é escolhida para que o primeiro filho caia no estado livre candidato
+        base = static_cast<std::int32_t>(position) - first;
+        if (base >= 0) {
+            std::size_t last = static_cast<std::size_t>(base + keys[count - 1] + 1);
+            if (last >= _capacity) {
+                grow(last + 1 > 2 * _capacity ? last + 1 : 2 * _capacity);
+            }
+
+            bool fits = true;
+            for (std::size_t i = 1; i < count && fits; ++i) {
+                fits = _check[base + keys[i] + 1] == -1;
+            }
+
+            if (fits) {
+                break;
+            }
+        }
+
+        // Procura o próximo estado livre
+        do {
+            ++position;
+            if (position >= _capacity) {
+                grow(2 * _capacity);
+            }
+        } while (_check[position] != -1);
+    }
+
+    _base[state] = base;
+    for (std::size_t i = 0; i < count; ++i) {
+        _check[base + keys[i] + 1] = state;
+    }
+
+    return base;
+}
+
+/**
+ * Libera os vetores.
+ **/
+inline void structures::DoubleArrayTrie::release() {
+    if (_mapping != nullptr) {  // Os vetores apontam para o arquivo mapeado
+        munmap(_mapping, _mapping_size);
+        _mapping = nullptr;
+        _mapping_size = 0u;
+    } else {
+        delete[] _base;
+        delete[] _check;
+        delete[] _prefix_count;
+        delete[] _position;
+        delete[] _length;
+    }
+}
+
+/**
+ * Grava a árvore em um arquivo de índice versionado. Os estados livres do fim dos vetores não
+ * são gravados e o cabeçalho leva um checksum de todos os bytes do arquivo, inclusive os dele.
+ *      Parâmetros:
+ *          filename (string): Nome do arquivo.
+ **/
+inline void structures::DoubleArrayTrie::save(const string& filename) const {
+    // Descarta os estados livres do fim dos vetores
+    std::size_t capacity = _capacity;
+    while (capacity > 1 && _check[capacity - 1] == -1) {
+        --capacity;
+    }
+
+    // Calcula os deslocamentos de cada vetor, alinhados a 8 bytes
+    IndexHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "PFXDAT\0\0", 8);
+    header.version = INDEX_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.capacity = capacity;
+    header.size = _size;
+    header.table = _table;
+
+    std::uint64_t offset = sizeof(IndexHeader);
+    std::uint64_t int_bytes = (capacity * sizeof(std::int32_t) + 7) & ~std::uint64_t(7);
+    std::uint64_t long_bytes = capacity * sizeof(std::uint64_t);
+    header.base_offset = offset;
+    header.check_offset = offset += int_bytes;
+    header.prefix_count_offset = offset += int_bytes;
+    header.position_offset = offset += long_bytes;
+    header.length_offset = offset += long_bytes;
+    header.file_size = offset += long_bytes;
+
+    // Os vetores são gravados na mesma ordem dos deslocamentos
+    const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    std::size_t padding_size = int_bytes - capacity * sizeof(std::int32_t);
+    struct Section {
+        const void* data;
+        std::size_t size;
+    } sections[] = {{_base, capacity * sizeof(std::int32_t)},
+                    {padding, padding_size},
+                    {_check, capacity * sizeof(std::int32_t)},
+                    {padding, padding_size},
+                    {_prefix_count, long_bytes},
+                    {_position, long_bytes},
+                    {_length, long_bytes}};
+
+    header.checksum = checksum(header);
+    for (const Section& section : sections) {
+        header.checksum = checksum(header.checksum, section.data, section.size);
+    }
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::out_of_range("File not found");
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const Section& section : sections) {
+        file.write(static_cast<const char*>(section.data), section.size);
+    }
+
+    if (!file) {
+        throw std::out_of_range("Write Error");
+    }
+}
+
+/**
+ * Mapeia um arquivo de índice na memória. Os vetores apontam diretamente para as páginas
+ * mapeadas, então não há desserialização e processos que usam o mesmo arquivo compartilham a
+ * memória do cache de páginas.
+ *      Parâmetros:
+ *          filename (string): Nome do arquivo.
+ *          verify (bool): Verifica o checksum (lê o arquivo inteiro uma vez).
+ *      Retorno (DoubleArrayTrie): Árvore que consulta o arquivo mapeado.
+ **/
+inline structures::DoubleArrayTrie structures::DoubleArrayTrie::load(const string& filename,
+                                                                     bool verify) {
+    int descriptor = open(filename.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        throw std::out_of_range("File not found");
+    }
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 ||
+        static_cast<std::size_t>(status.st_size) < sizeof(IndexHeader)) {
+        close(descriptor);
+        throw std::out_of_range("Invalid index file");
+    }
+
+    std::size_t size = static_cast<std::size_t>(status.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0);
+    close(descriptor);  // O mapeamento continua válido sem o descritor
+
+    if (mapping == MAP_FAILED) {
+        throw std::out_of_range("Allocation Error");
+    }
+
+    // Valida o cabeçalho e os limites de cada vetor antes de usar qualquer deslocamento. A
+    // capacidade é validada antes, então os tamanhos dos vetores não transbordam
+    const char* bytes = static_cast<const char*>(mapping);
+    const IndexHeader* header = static_cast<const IndexHeader*>(mapping);
+
+    bool valid = std::memcmp(header->magic, "PFXDAT\0\0", 8) == 0 &&
+                 header->version == INDEX_VERSION && header->byte_order == BYTE_ORDER_MARK &&
+                 header->file_size == size && header->capacity > 0 &&
+                 header->capacity < (std::uint64_t(1) << 31);
+
+    if (valid) {
+        std::uint64_t int_bytes = header->capacity * sizeof(std::int32_t);
+        std::uint64_t long_bytes = header->capacity * sizeof(std::uint64_t);
+
+        // O vetor fica depois do cabeçalho, alinhado a 8 bytes e dentro do arquivo
+        auto fits = [&](std::uint64_t offset, std::uint64_t section_size) {
+            return offset >= sizeof(IndexHeader) && offset % 8 == 0 && offset <= size &&
+                   section_size <= size - offset;
+        };
+
+        valid = fits(header->base_offset, int_bytes) && fits(header->check_offset, int_bytes) &&
+                fits(header->prefix_count_offset, long_bytes) &&
+                fits(header->position_offset, long_bytes) &&
+                fits(header->length_offset, long_bytes);
+
+        // Cada byte da tabela é uma letra ou um valor de AlphabetIndex
+        for (std::int16_t key : header->table) {
+            valid = valid && key >= AlphabetIndex::SKIP;
+        }
+    }
+
+    if (valid && verify) {
+        valid = checksum(checksum(*header), bytes + sizeof(IndexHeader),
+                         size - sizeof(IndexHeader)) == header->checksum;
+    }
+
+    if (!valid) {
+        munmap(mapping, size);
+        throw std::out_of_range("Invalid index file");
+    }
+
+    DoubleArrayTrie trie;
+    trie.release();  // Descarta os vetores próprios da árvore vazia
+
+    trie._base = reinterpret_cast<std::int32_t*>(const_cast<char*>(bytes) + header->base_offset);
+    trie._check =
+        reinterpret_cast<std::int32_t*>(const_cast<char*>(bytes) + header->check_offset);
+    trie._prefix_count = reinterpret_cast<std::uint64_t*>(const_cast<char*>(bytes) +
+                                                          header->prefix_count_offset);
+    trie._position =
+        reinterpret_cast<std::uint64_t*>(const_cast<char*>(bytes) + header->position_offset);
+    trie._length =
+        reinterpret_cast<std::uint64_t*>(const_cast<char*>(bytes) + header->length_offset);
+    trie._capacity = header->capacity;
+    trie._size = header->size;
+    trie._mapping = mapping;
+    trie._mapping_size = size;
+    trie._table = header->table;
+
+    return trie;
+}
+
+/**
+ * Verifica se o arquivo começa com a identificação do formato de índice.
+ *      Parâmetros:
+ *          filename (string): Nome do arquivo.
+ *      Retorno (bool): Verdadeiro caso o arquivo seja um arquivo de índice.
+ **/
+inline bool structures::DoubleArrayTrie::is_index(const string& filename) {
+    char magic[8];
+    std::ifstream file(filename, std::ios::binary);
+
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, "PFXDAT\0\0", 8) == 0;
+}
+
+/**
+ * Acumula bytes no checksum FNV-1a de 64 bits.
+ *      Parâmetros:
+ *          hash (std::uint64_t): Valor acumulado até agora.
+ *          data (const void*): Bytes a serem acumulados.
+ *          size (std::size_t): Quantidade de bytes.
+ *      Retorno (std::uint64_t): Novo valor acumulado.
+ **/
+inline std::uint64_t structures::DoubleArrayTrie::checksum(std::uint64_t hash, const void* data,
+                                                           std::size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+/**
+ * Retorna o checksum FNV-1a (std::uint64_t) do cabeçalho. O campo do checksum é zerado antes,
+ * então o valor gravado nele não entra no próprio cálculo.
+ *      Parâmetros:
+ *          header (const IndexHeader&): Cabeçalho do arquivo.
+ **/
+inline std::uint64_t structures::DoubleArrayTrie::checksum(const IndexHeader& header) {
+    IndexHeader copy;
+    std::memcpy(&copy, &header, sizeof(copy));
+    copy.checksum = 0u;
+
+    return checksum(FNV_OFFSET, &copy, sizeof(copy));
+}
+
+/**
+ * Converte a árvore em uma árvore imutável em vetor duplo (BASE/CHECK). Os nós são percorridos
+ * em largura e cada nó recebe um estado com a sua contagem, posição e comprimento. A tabela do
+ * alfabeto vai junto, então as pesquisas convertem os bytes da mesma forma que a árvore.
+ *      Retorno (DoubleArrayTrie): Árvore imutável com os mesmos prefixos.
+ **/
+template <typename Alphabet>
+structures::DoubleArrayTrie structures::PrefixTree<Alphabet>::freeze() const {
+    // Nó que já tem um estado mas cujos filhos ainda não foram colocados
+    struct Pending {
+        const Node* node;    // Nó da árvore
+        std::int32_t state;  // Estado do nó
+    };
+
+    DoubleArrayTrie trie;
+    trie._size = _size;
+    trie._table = Alphabet::TABLE;
+
+    structures::ArrayList<Pending> queue(_pool.size());  // Fila da busca em largura
+    unsigned char keys[Alphabet::SIZE];                  // Índices das letras dos filhos
+    const Node* children[Alphabet::SIZE];                // Filhos do nó atual
+    std::size_t count = 0;                               // Quantidade de filhos
+
+    // Coloca os filhos da raiz
+    for (std::size_t i = 0; i < Alphabet::SIZE; ++i) {
+        if (_root[i] != nullptr) {
+            keys[count] = static_cast<unsigned char>(i);
+            children[count++] = _root[i];
+        }
+    }
+
+    std::int32_t state = 0;
+    for (std::size_t head = 0;; ++head) {
+        if (count > 0) {
+            std::int32_t base = trie.place(state, keys, count);
+            for (std::size_t i = 0; i < count; ++i) {
+                queue.push_back({children[i], base + keys[i] + 1});
+            }
+        }
+
+        if (head == queue.size()) {  // Todos os nós receberam um estado
+            break;
+        }
+
+        // Copia os dados do próximo nó da fila e obtém os seus filhos
+        const Node* node = queue[head].node;
+        state = queue[head].state;
+        trie._prefix_count[state] = node->prefix_count();
+        trie._position[state] = node->position();
+        trie._length[state] = node->length();
+
+        count = 0;
+        node->for_each_child([&](unsigned char key, const Node* child) {
+            keys[count] = key;
+            children[count++] = child;
+        });
+    }
+
+    return trie;
+}
+
+
+/**
+ * Grava a árvore em um arquivo de índice que pode ser mapeado com DoubleArrayTrie::load.
+ *      Parâmetros:
+ *          filename (string): Nome do arquivo.
+ **/
+template <typename Alphabet>
+void structures::PrefixTree<Alphabet>::save(const string& filename) const {
+    freeze().save(filename);
+}
+
+#endif
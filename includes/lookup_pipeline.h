@@ -0,0 +1,259 @@
+// Copyright [2021] <Eric Fernandes Evaristo>
+// v1.0.1
+
+#ifndef STRUCTURES_LOOKUP_PIPELINE_H
+#define STRUCTURES_LOOKUP_PIPELINE_H
+
+#include <condition_variable>
+#include <cstdint>    // std::size_t
+#include <deque>
+#include <exception>  // std::exception_ptr
+#include <istream>
+#include <memory>     // std::unique_ptr
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>  // std::string_view
+#include <thread>
+#include <vector>
+
+#include "lookup_result.h"
+
+using std::string;
+
+namespace structures {
+
+// Classe LookupPipeline, responde pesquisas de uma entrada grande em três estágios. O leitor
+// divide a entrada em blocos de palavras, várias threads pesquisam os blocos em um índice que
+// só é lido, e o escritor grava as respostas dos blocos na ordem da entrada. A quantidade de
+// blocos em andamento é limitada, então a memória não cresce com o tamanho da entrada
+class LookupPipeline {
+   public:
+    // Construtor
+    explicit LookupPipeline(unsigned threads = std::thread::hardware_concurrency(),
+                            std::size_t chunk_size = DEFAULT_CHUNK_SIZE);
+    // Responde as palavras da entrada até a palavra de parada
+    template <typename Index, typename Format>
+    void run(const Index& index, std::istream& input, std::ostream& output, Format format,
+             std::string_view stop = "0") const;
+
+   private:
+    // Bloco da entrada. As palavras são visões sobre o texto do próprio bloco
+    struct Batch {
+        string text;                          // Texto do bloco
+        std::vector<std::string_view> words;  // Palavras do bloco
+        string output;                        // Respostas formatadas
+        bool done = false;                    // Indica se as respostas estão prontas
+    };
+
+    unsigned _threads;        // Threads que fazem as pesquisas
+    std::size_t _chunk_size;  // Bytes lidos de cada vez
+
+    static const std::size_t DEFAULT_CHUNK_SIZE = 1u << 20;
+    static const std::size_t BATCHES_PER_THREAD = 4u;  // Blocos em andamento por thread
+};
+
+}  // namespace structures
+
+/**
+ * Constrói um objeto structures::LookupPipeline.
+ *      Parâmetros:
+ *          threads: Quantidade (unsigned) de threads de pesquisa (0 usa uma).
+ *          chunk_size: Quantidade (std::size_t) de bytes lidos da entrada de cada vez.
+ **/
+inline structures::LookupPipeline::LookupPipeline(unsigned threads, std::size_t chunk_size) {
+    _threads = threads > 0 ? threads : 1u;
+    _chunk_size = chunk_size > 0 ? chunk_size : DEFAULT_CHUNK_SIZE;
+}
+
+/**
+ * Lê as palavras da entrada, separadas por espaços em branco como em "cin >>", até a palavra de
+ * parada ou o fim da entrada, e grava a resposta de cada uma na ordem da entrada. A entrada é
+ * lida em blocos grandes e cortada no último espaço em branco, então nenhuma palavra é dividida
+ * entre dois blocos. A saída só é gravada bloco a bloco, sem esvaziar o buffer a cada linha.
+ *      Parâmetros:
+ *          index: Índice (Dictionary, PrefixTree ou DoubleArrayTrie) com lookup constante, que é
+ *              pesquisado por várias threads ao mesmo tempo.
+ *          input: Entrada (std::istream&) com as palavras.
+ *          output: Saída (std::ostream&) das respostas.
+ *          format: Função que recebe a palavra (const string&), o resultado
+ *              (const LookupResult&) e acrescenta a resposta em um texto (string&).
+ *          stop: Palavra (std::string_view) que encerra a entrada.
+ **/
+template <typename Index, typename Format>
+void structures::LookupPipeline::run(const Index& index, std::istream& input, std::ostream& output,
+                                     Format format, std::string_view stop) const {
+    std::mutex mutex;
+    std::condition_variable work_ready;   // Há blocos para pesquisar (ou a leitura acabou)
+    std::condition_variable batch_done;   // Um bloco ficou pronto (ou a leitura acabou)
+    std::condition_variable space_ready;  // Um bloco foi gravado
+
+    std::deque<std::unique_ptr<Batch>> window;  // Blocos em andamento, na ordem da entrada
+    std::deque<Batch*> pending;                 // Blocos que ainda não foram pesquisados
+    bool reading = true;                        // Indica se o leitor ainda pode criar blocos
+    bool failed = false;                        // Indica se algum estágio falhou
+    std::exception_ptr error;                   // Primeira falha
+
+    const std::size_t limit = _threads * BATCHES_PER_THREAD;
+
+    auto fail = [&](std::exception_ptr exception) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!failed) {
+            failed = true;
+            error = exception;
+        }
+        work_ready.notify_all();
+        batch_done.notify_all();
+        space_ready.notify_all();
+    };
+
+    // Pesquisa os blocos pendentes. Cada thread reaproveita o mesmo string para as palavras
+    auto search = [&]() {
+        string word;
+
+        try {
+            while (true) {
+                Batch* batch;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    work_ready.wait(lock, [&] { return failed || !pending.empty() || !reading; });
+                    if (failed || pending.empty()) {
+                        return;
+                    }
+                    batch = pending.front();
+                    pending.pop_front();
+                }
+
+                for (std::string_view view : batch->words) {
+                    word.assign(view.data(), view.size());
+                    format(word, index.lookup(word), batch->output);
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                batch->done = true;
+                batch_done.notify_all();
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    };
+
+    // Grava os blocos prontos na ordem da entrada
+    auto write = [&]() {
+        try {
+            while (true) {
+                std::unique_ptr<Batch> batch;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    batch_done.wait(lock, [&] {
+                        return failed || (!window.empty() && window.front()->done) ||
+                               (window.empty() && !reading);
+                    });
+                    if (failed || window.empty()) {
+                        return;
+                    }
+                    batch = std::move(window.front());
+                    window.pop_front();
+                    space_ready.notify_all();
+                }
+
+                output.write(batch->output.data(),
+                             static_cast<std::streamsize>(batch->output.size()));
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    };
+
+    std::vector<std::thread> workers;
+    try {
+        for (unsigned i = 0; i < _threads; ++i) {
+            workers.emplace_back(search);
+        }
+        workers.emplace_back(write);
+    } catch (...) {
+        fail(std::current_exception());
+    }
+
+    // O leitor corre na thread atual
+    try {
+        string carry;  // Começo de uma palavra cortada no fim do bloco anterior
+        bool finished = false;
+
+        while (!finished) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                space_ready.wait(lock, [&] { return failed || window.size() < limit; });
+                if (failed) {
+                    break;
+                }
+            }
+
+            std::unique_ptr<Batch> batch(new Batch());
+            batch->text.swap(carry);
+            std::size_t kept = batch->text.size();
+            batch->text.resize(kept + _chunk_size);
+            std::streamsize count = input.rdbuf()->sgetn(&batch->text[kept],
+                                                         static_cast<std::streamsize>(_chunk_size));
+            batch->text.resize(kept + static_cast<std::size_t>(count > 0 ? count : 0));
+            finished = count <= 0;
+
+            // Corta o bloco no último espaço em branco; o resto vai para o próximo bloco
+            if (!finished) {
+                std::size_t cut = batch->text.find_last_of(" \t\n\v\f\r");
+                cut = cut == string::npos ? 0 : cut + 1;
+                carry.assign(batch->text, cut, string::npos);
+                batch->text.resize(cut);
+            }
+
+            // Separa as palavras até a palavra de parada
+            const string& text = batch->text;
+            std::size_t i = 0;
+            while (i < text.size()) {
+                i = text.find_first_not_of(" \t\n\v\f\r", i);
+                if (i == string::npos) {
+                    break;
+                }
+                std::size_t end = text.find_first_of(" \t\n\v\f\r", i);
+                end = end == string::npos ? text.size() : end;
+
+                std::string_view word(text.data() + i, end - i);
+                if (word == stop) {
+                    finished = true;
+                    break;
+                }
+                batch->words.push_back(word);
+                i = end;
+            }
+
+            if (!batch->words.empty()) {
+                batch->output.reserve(batch->words.size() * 32);
+                std::lock_guard<std::mutex> lock(mutex);
+                pending.push_back(batch.get());
+                window.push_back(std::move(batch));
+                work_ready.notify_one();
+            }
+        }
+    } catch (...) {
+        fail(std::current_exception());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        reading = false;
+        work_ready.notify_all();
+        batch_done.notify_all();
+    }
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    output.flush();
+}
+
+#endif
@@ -0,0 +1,19 @@
+// Copyright [2021] <Eric Fernandes Evaristo>
+// v1.0.1
+
+#ifndef STRUCTURES_LOOKUP_RESULT_H
+#define STRUCTURES_LOOKUP_RESULT_H
+
+namespace structures {
+
+// Resultado de uma pesquisa completa de um prefixo
+struct LookupResult {
+    unsigned long prefix_count;  // Quantidade de prefixos contidos no prefixo
+    bool found;                  // Indica se o prefixo exato está na árvore
+    unsigned long position;      // Posição do prefixo exato (0 caso não seja encontrado)
+    unsigned long length;        // Comprimento da linha do prefixo exato (0 caso não exista)
+};
+
+}  // namespace structures
+
+#endif
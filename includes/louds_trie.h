@@ -0,0 +1,409 @@
+// Copyright [2021] <Eric Fernandes Evaristo>
+// v1.0.1
+
+#ifndef STRUCTURES_LOUDS_TRIE_H
+#define STRUCTURES_LOUDS_TRIE_H
+
+#include <algorithm>  // std::max
+#include <cstdint>    // std::size_t, SIZE_MAX
+#include <string>
+#include <vector>
+
+#include "alphabet.h"
+#include "array_list.h"
+#include "bit_vector.h"
+#include "lookup_result.h"
+#include "prefix_tree.h"
+
+using std::string;
+
+namespace structures {
+
+template <typename Alphabet>
+class PrefixTree;
+
+// Classe LoudsTrie, árvore de prefixos sucinta e imutável. Os nós são numerados em largura (a
+// raiz é o nó 0) e a forma da árvore é um vetor LOUDS: "10" e depois, para cada nó, um 1 por
+// filho seguido de um 0, cerca de 2 bits por nó. Os filhos do nó v começam logo depois do
+// v-ésimo zero e são os nós consecutivos a partir de (posição - v - 1). As letras, as contagens
+// e os dados dos prefixos completos ficam em vetores com a largura mínima de bits. A árvore é
+// construída por PrefixTree::succinct, definida no fim deste arquivo, e não muda
+template <typename Alphabet = LowercaseAscii>
+class LoudsTrie {
+   public:
+    // Construtor padrão (árvore vazia)
+    LoudsTrie();
+    // Verifica se contém um prefixo
+    bool contains(const string& prefix) const;
+    // Verifica se a árvore está vazia
+    bool empty() const;
+    // Retorna o tamanho da árvore
+    std::size_t size() const;
+    // Retorna a quantidade de nós da árvore (sem a raiz)
+    std::size_t node_count() const;
+    // Retorna os prefixos que começam com o prefixo, em ordem alfabética
+    ArrayList<string> complete(const string& prefix) const;
+    // Retorna o número de prefixos contidos no prefixo do parâmetro
+    unsigned long prefix_search(const string& prefix) const;
+    // Retorna a posição do prefixo
+    unsigned long position_search(const string& prefix) const;
+    // Retorna o comprimento da linha do prefixo
+    unsigned long length_search(const string& prefix) const;
+    // Retorna todos os dados do prefixo com uma única descida
+    LookupResult lookup(const string& prefix) const;
+    // Retorna os bytes usados pela árvore
+    std::size_t bytes() const;
+
+   private:
+    template <typename>
+    friend class PrefixTree;
+
+    static const std::size_t NONE = SIZE_MAX;  // Nó que não existe
+
+    BitVector _louds;           // Forma da árvore
+    BitVector _terminal;        // Indica os nós que são o fim de um prefixo (raiz incluída)
+    PackedArray _labels;        // Letra de cada nó, menos a raiz (nó v no índice v - 1)
+    PackedArray _prefix_count;  // Quantidade de prefixos abaixo de cada nó, menos a raiz
+    PackedArray _position;      // Posição de cada prefixo completo, na ordem dos nós
+    PackedArray _length;        // Comprimento de cada prefixo completo, na ordem dos nós
+    std::size_t _size;          // Quantidade de prefixos
+
+    // Retorna o primeiro filho de um nó e a quantidade de filhos
+    std::size_t children(std::size_t node, std::size_t& count) const;
+    // Retorna o filho de um nó pela letra
+    std::size_t child(std::size_t node, std::size_t key) const;
+    // Desce pelas letras de um prefixo
+    std::size_t find(const string& prefix, string* word = nullptr) const;
+};
+
+}  // namespace structures
+
+/**
+ * Constrói um objeto structures::LoudsTrie vazio. Apenas a raiz existe, sem filhos.
+ **/
+template <typename Alphabet>
+structures::LoudsTrie<Alphabet>::LoudsTrie() : _labels(Alphabet::SIZE - 1) {
+    _size = 0;
+
+    _louds.push_back(true);
+    _louds.push_back(false);
+    _louds.push_back(false);
+    _louds.build();
+    _terminal.push_back(false);
+    _terminal.build();
+}
+
+/**
+ * Verifica se o prefixo está na árvore.
+ *      Parâmetros:
+ *          prefix: Prefixo (string) a ser procurado.
+ *      Retorno (bool): Verdadeiro caso o prefixo exato exista.
+ **/
+template <typename Alphabet>
+bool structures::LoudsTrie<Alphabet>::contains(const string& prefix) const {
+    return lookup(prefix).found;
+}
+
+/**
+ * Retorna verdadeiro caso a árvore não tenha prefixos.
+ **/
+template <typename Alphabet>
+bool structures::LoudsTrie<Alphabet>::empty() const {
+    return _size == 0;
+}
+
+/**
+ * Retorna a quantidade de prefixos (std::size_t).
+ **/
+template <typename Alphabet>
+std::size_t structures::LoudsTrie<Alphabet>::size() const {
+    return _size;
+}
+
+/**
+ * Retorna a quantidade de nós (std::size_t), sem contar a raiz.
+ **/
+template <typename Alphabet>
+std::size_t structures::LoudsTrie<Alphabet>::node_count() const {
+    return _labels.size();
+}
+
+/**
+ * Retorna os prefixos que começam com o prefixo do parâmetro, em ordem alfabética. A subárvore
+ * do prefixo é percorrida em profundidade com uma pilha explícita; os filhos de um nó são
+ * empilhados do último para o primeiro, então saem em ordem. Os prefixos são escritos com os
+ * caracteres do alfabeto, como em PrefixTree::complete.
+ *      Parâmetros:
+ *          prefix: Prefixo (string) que está sendo completado (vazio completa todos).
+ *      Retorno (ArrayList<string>): Prefixos encontrados (vazia caso não existam).
+ **/
+template <typename Alphabet>
+structures::ArrayList<string> structures::LoudsTrie<Alphabet>::complete(
+    const string& prefix) const {
+    // Nó da pilha e a quantidade de letras do prefixo até ele
+    struct Frame {
+        std::size_t node;
+        std::size_t depth;
+    };
+
+    ArrayList<string> list;
+    string word;
+    std::size_t start = find(prefix, &word);
+    if (start == NONE) {
+        return list;
+    }
+
+    std::size_t base = word.size();
+    std::vector<Frame> stack;
+    stack.push_back({start, base});
+
+    while (!stack.empty()) {
+        Frame frame = stack.back();
+        stack.pop_back();
+
+        if (frame.depth > base) {  // A raiz da subárvore já está na palavra
+            word.resize(frame.depth - 1);
+            word.push_back(Alphabet::symbol(_labels[frame.node - 1]));
+        }
+
+        if (_terminal[frame.node]) {
+            list.push_back(word);
+        }
+
+        std::size_t count;
+        std::size_t first = children(frame.node, count);
+        for (std::size_t i = count; i > 0; --i) {
+            stack.push_back({first + i - 1, frame.depth + 1});
+        }
+    }
+
+    return list;
+}
+
+/**
+ * Retorna o número de prefixos contidos no prefixo do parâmetro.
+ *      Parâmetros:
+ *          prefix: Prefixo (string) a ser pesquisado.
+ *      Retorno (unsigned long): Quantidade de prefixos (0 caso o caminho não exista).
+ **/
+template <typename Alphabet>
+unsigned long structures::LoudsTrie<Alphabet>::prefix_search(const string& prefix) const {
+    return lookup(prefix).prefix_count;
+}
+
+/**
+ * Retorna a posição do prefixo.
+ *      Parâmetros:
+ *          prefix: Prefixo (string) a ser pesquisado.
+ *      Retorno (unsigned long): Posição (0 caso o prefixo não exista).
+ **/
+template <typename Alphabet>
+unsigned long structures::LoudsTrie<Alphabet>::position_search(const string& prefix) const {
+    return lookup(prefix).position;
+}
+
+/**
+ * Retorna o comprimento da linha do prefixo.
+ *      Parâmetros:
+ *          prefix: Prefixo (string) a ser pesquisado.
+ *      Retorno (unsigned long): Comprimento (0 caso o prefixo não exista).
+ **/
+template <typename Alphabet>
+unsigned long structures::LoudsTrie<Alphabet>::length_search(const string& prefix) const {
+    return lookup(prefix).length;
+}
+
+/**
+ * Retorna todos os dados do prefixo com uma única descida. Os dados de um prefixo completo
+ * ficam no índice do rank do nó no vetor de nós terminais.
+ *      Parâmetros:
+ *          prefix: Prefixo (string) a ser pesquisado.
+ *      Retorno (LookupResult): Contagem, existência, posição e comprimento do prefixo.
+ **/
+template <typename Alphabet>
+structures::LookupResult structures::LoudsTrie<Alphabet>::lookup(const string& prefix) const {
+    LookupResult result = {0, false, 0, 0};
+
+    std::size_t node = find(prefix);
+    if (node == NONE || node == 0) {  // O prefixo vazio não corresponde a nenhum nó
+        return result;
+    }
+
+    result.prefix_count = static_cast<unsigned long>(_prefix_count[node - 1]);
+
+    if (_terminal[node]) {  // O nó é o fim de um prefixo
+        std::size_t index = _terminal.rank1(node);
+        result.found = true;
+        result.position = static_cast<unsigned long>(_position[index]);
+        result.length = static_cast<unsigned long>(_length[index]);
+    }
+
+    return result;
+}
+
+/**
+ * Retorna os bytes (std::size_t) usados pela árvore, incluindo os índices de rank e select.
+ **/
+template <typename Alphabet>
+std::size_t structures::LoudsTrie<Alphabet>::bytes() const {
+    return sizeof(*this) + _louds.bytes() + _terminal.bytes() + _labels.bytes() +
+           _prefix_count.bytes() + _position.bytes() + _length.bytes();
+}
+
+/**
+ * Retorna o primeiro filho de um nó. Os filhos do nó v começam depois do v-ésimo zero (contando
+ * a partir de 0); antes dessa posição há v + 1 zeros, então os uns antes dela, que são a ordem
+ * do primeiro filho, não precisam de rank.
+ *      Parâmetros:
+ *          node: Nó (std::size_t).
+ *          count: Quantidade (std::size_t&) de filhos, escrita pela função.
+ *      Retorno (std::size_t): Primeiro filho (sem significado caso count seja 0).
+ **/
+template <typename Alphabet>
+std::size_t structures::LoudsTrie<Alphabet>::children(std::size_t node,
+                                                      std::size_t& count) const {
+    std::size_t begin = _louds.select0(node) + 1;
+    count = _louds.next_zero(begin) - begin;
+
+    return begin - node - 1;
+}
+
+/**
+ * Retorna o filho de um nó pela letra. As letras dos filhos estão em ordem, então a busca é
+ * binária.
+ *      Parâmetros:
+ *          node: Nó (std::size_t).
+ *          key: Índice (std::size_t) da letra.
+ *      Retorno (std::size_t): Filho (NONE caso não exista).
+ **/
+template <typename Alphabet>
+std::size_t structures::LoudsTrie<Alphabet>::child(std::size_t node, std::size_t key) const {
+    std::size_t count;
+    std::size_t low = children(node, count);
+    std::size_t end = low + count;
+    std::size_t high = end;
+
+    while (low < high) {
+        std::size_t middle = low + (high - low) / 2;
+        if (_labels[middle - 1] < key) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low < end && _labels[low - 1] == key ? low : NONE;
+}
+
+/**
+ * Desce pelas letras de um prefixo. Os bytes que o alfabeto ignora são pulados e um byte fora
+ * do alfabeto encerra a descida.
+ *      Parâmetros:
+ *          prefix: Prefixo (string) a ser procurado.
+ *          word: Texto (string*) que recebe o prefixo escrito com os caracteres do alfabeto
+ *              (opcional).
+ *      Retorno (std::size_t): Nó do prefixo (0 caso ele não tenha letras, NONE caso não exista).
+ **/
+template <typename Alphabet>
+std::size_t structures::LoudsTrie<Alphabet>::find(const string& prefix, string* word) const {
+    std::size_t node = 0;
+
+    for (char character : prefix) {
+        int key = Alphabet::index(static_cast<unsigned char>(character));
+
+        if (key == AlphabetIndex::SKIP) {
+            continue;
+        }
+        if (key == AlphabetIndex::INVALID) {
+            return NONE;
+        }
+
+        node = child(node, static_cast<std::size_t>(key));
+        if (node == NONE) {
+            return NONE;
+        }
+
+        if (word != nullptr) {
+            word->push_back(Alphabet::symbol(static_cast<std::size_t>(key)));
+        }
+    }
+
+    return node;
+}
+
+/**
+ * Converte a árvore em uma árvore sucinta. Os nós são numerados em largura e a forma de cada nó
+ * (um 1 por filho e um 0) é gravada no vetor LOUDS na mesma ordem, junto com a letra, a contagem
+ * e a marca de fim de prefixo. As posições e os comprimentos só são gravados depois, em uma
+ * segunda passagem pela fila, porque a largura de bits deles depende do maior valor.
+ *      Retorno (LoudsTrie<Alphabet>): Árvore sucinta com os mesmos prefixos.
+ **/
+template <typename Alphabet>
+structures::LoudsTrie<Alphabet> structures::PrefixTree<Alphabet>::succinct() const {
+    // Nó da fila da busca em largura e a sua letra (nulo representa a raiz)
+    struct Queued {
+        const Node* node;
+        unsigned char key;
+    };
+
+    LoudsTrie<Alphabet> trie;
+    trie._size = _size;
+    trie._louds = BitVector();
+    trie._terminal = BitVector();
+    trie._prefix_count = PackedArray(_size);
+
+    std::vector<Queued> queue;
+    queue.reserve(_pool.size() + 1);
+    queue.push_back({nullptr, 0});
+
+    unsigned long max_position = 0;
+    unsigned long max_length = 0;
+
+    trie._louds.push_back(true);
+    trie._louds.push_back(false);
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        const Node* node = queue[head].node;
+
+        if (node != nullptr) {
+            trie._labels.push_back(queue[head].key);
+            trie._prefix_count.push_back(node->prefix_count());
+            trie._terminal.push_back(node->length() != 0);
+            max_position = std::max(max_position, node->position());
+            max_length = std::max(max_length, node->length());
+        } else {
+            trie._terminal.push_back(false);
+        }
+
+        auto add = [&](unsigned char key, const Node* child) {
+            trie._louds.push_back(true);
+            queue.push_back({child, key});
+        };
+
+        if (node == nullptr) {
+            for (std::size_t i = 0; i < Alphabet::SIZE; ++i) {
+                if (_root[i] != nullptr) {
+                    add(static_cast<unsigned char>(i), _root[i]);
+                }
+            }
+        } else {
+            node->for_each_child(add);
+        }
+
+        trie._louds.push_back(false);
+    }
+
+    trie._position = PackedArray(max_position);
+    trie._length = PackedArray(max_length);
+    for (std::size_t i = 1; i < queue.size(); ++i) {
+        if (queue[i].node->length() != 0) {
+            trie._position.push_back(queue[i].node->position());
+            trie._length.push_back(queue[i].node->length());
+        }
+    }
+
+    trie._louds.build();
+    trie._terminal.build();
+    return trie;
+}
+
+#endif
@@ -0,0 +1,336 @@
+// Copyright [2021] <Eric Fernandes Evaristo>
+// v1.0.1
+
+#ifndef STRUCTURES_NODE_ARENA_H
+#define STRUCTURES_NODE_ARENA_H
+
+#include <cstdint>      // std::size_t
+#include <cstdlib>      // std::malloc, std::free
+#include <new>          // placement new
+#include <stdexcept>    // C++ exceptions
+#include <type_traits>  // std::is_trivially_destructible
+#include <utility>      // std::forward
+
+namespace structures {
+
+template <typename T>
+// Classe NodeArena, alocador de nós em blocos contíguos. Sem blocos (pooled falso) cada nó é uma
+// alocação própria com new e delete, e quem usa a arena devolve os nós um a um antes de clear
+class NodeArena {
+   public:
+    // Construtor padrão
+    NodeArena();
+    // Construtor com parâmetros
+    explicit NodeArena(std::size_t chunk_size, bool pooled = true);
+    // Destrutor
+    ~NodeArena();
+    // Aloca e constrói um nó
+    template <typename... Args>
+    T* allocate(Args&&... args);
+    // Devolve um nó para a lista de livres
+    void deallocate(T* node);
+    // Libera todos os blocos de uma só vez
+    void clear();
+    // Toma todos os blocos de outra arena
+    void splice(NodeArena& other);
+    // Passa a contar nós construídos fora dos blocos da arena
+    void adopt(std::size_t count);
+    // Indica se os nós são alocados em blocos
+    bool pooled() const;
+    // Retorna a quantidade de nós em uso
+    std::size_t size() const;
+    // Retorna a quantidade de blocos alocados
+    std::size_t chunk_count() const;
+    // Retorna a quantidade de nós por bloco
+    std::size_t chunk_size() const;
+    // Retorna os bytes ocupados pelos nós em uso
+    std::size_t used_bytes() const;
+    // Retorna os bytes alocados em blocos
+    std::size_t reserved_bytes() const;
+    // Retorna os bytes do espaço de um nó
+    static constexpr std::size_t slot_size();
+
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+
+   private:
+    // Espaço de um nó. Quando o nó está livre o espaço guarda o próximo livre
+    union Slot {
+        Slot* next;                                // Próximo espaço livre
+        alignas(T) unsigned char storage[sizeof(T)];  // Armazenamento do nó
+    };
+
+    // Bloco contíguo de espaços
+    struct Chunk {
+        Chunk* next;  // Bloco anterior (lista encadeada de blocos)
+        Slot* slots;  // Primeiro espaço do bloco
+    };
+
+    Chunk* _chunks;           // Lista de blocos
+    Slot* _free_list;         // Lista de espaços devolvidos
+    Slot* _cursor;            // Próximo espaço nunca usado do bloco atual
+    Slot* _end;               // Fim do bloco atual
+    std::size_t _chunk_size;  // Quantidade de espaços por bloco
+    std::size_t _chunk_count; // Quantidade de blocos
+    std::size_t _size;        // Quantidade de nós em uso
+    bool _pooled;             // Indica se os nós são alocados em blocos
+
+    // Aloca um novo bloco
+    void grow();
+
+    static const std::size_t DEFAULT_CHUNK_SIZE = 4096u;
+
+    // Os nós nunca são destruídos individualmente na liberação em bloco
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "NodeArena só armazena tipos trivialmente destrutíveis");
+};
+
+}  // namespace structures
+
+/**
+ * Constrói um objeto structures::NodeArena<T>.
+ **/
+template <typename T>
+structures::NodeArena<T>::NodeArena() : NodeArena(DEFAULT_CHUNK_SIZE) {}
+
+/**
+ * Constrói um objeto structures::NodeArena<T>.
+ *      Parâmetros:
+ *          chunk_size (std::size_t): quantidade de nós em cada bloco.
+ *          pooled (bool): indica se os nós são alocados em blocos (senão, um a um).
+ **/
+template <typename T>
+structures::NodeArena<T>::NodeArena(std::size_t chunk_size, bool pooled) {
+    _chunks = nullptr;
+    _free_list = nullptr;
+    _cursor = nullptr;
+    _end = nullptr;
+    _chunk_size = chunk_size > 0 ? chunk_size : DEFAULT_CHUNK_SIZE;
+    _chunk_count = 0u;
+    _size = 0u;
+    _pooled = pooled;
+}
+
+/**
+ * Destrói o objeto structures::NodeArena<T>.
+ **/
+template <typename T>
+structures::NodeArena<T>::~NodeArena() {
+    clear();
+}
+
+/**
+ * Aloca um nó e o constrói com os argumentos. Os nós devolvidos são reutilizados antes de
+ * avançar no bloco atual.
+ *      Parâmetros:
+ *          args: Argumentos do construtor do nó.
+ *      Retorno (T*): Ponteiro para o nó construído.
+ **/
+template <typename T>
+template <typename... Args>
+T* structures::NodeArena<T>::allocate(Args&&... args) {
+    Slot* slot;
+
+    if (_free_list != nullptr) {  // Reutiliza um espaço devolvido
+        slot = _free_list;
+        _free_list = _free_list->next;
+    } else if (!_pooled) {  // Cada nó é uma alocação própria
+        slot = new Slot;
+    } else {
+        if (_cursor == _end) {  // O bloco atual acabou
+            grow();
+        }
+
+        slot = _cursor++;
+    }
+
+    ++_size;
+    return new (slot->storage) T(std::forward<Args>(args)...);
+}
+
+/**
+ * Devolve o nó para a lista de livres, ou o libera caso a arena não use blocos. O nó deve ter
+ * sido alocado por esta arena.
+ *      Parâmetros:
+ *          node (T*): Nó a ser devolvido.
+ **/
+template <typename T>
+void structures::NodeArena<T>::deallocate(T* node) {
+    Slot* slot = reinterpret_cast<Slot*>(node);
+    --_size;
+
+    if (!_pooled) {
+        delete slot;
+        return;
+    }
+
+    slot->next = _free_list;
+    _free_list = slot;
+}
+
+/**
+ * Libera todos os blocos. Todos os ponteiros entregues pela arena se tornam inválidos. Sem
+ * blocos os nós já devem ter sido devolvidos com deallocate, e apenas a contagem é zerada.
+ **/
+template <typename T>
+void structures::NodeArena<T>::clear() {
+    while (_chunks != nullptr) {
+        Chunk* next = _chunks->next;
+        std::free(_chunks);
+        _chunks = next;
+    }
+
+    _free_list = nullptr;
+    _cursor = nullptr;
+    _end = nullptr;
+    _chunk_count = 0u;
+    _size = 0u;
+}
+
+/**
+ * Toma todos os blocos e espaços livres de outra arena, que fica vazia. Os nós da outra arena
+ * continuam válidos e passam a ser liberados por esta. O espaço nunca usado do bloco atual da
+ * outra arena só é devolvido quando esta for liberada.
+ *      Parâmetros:
+ *          other (NodeArena&): Arena que perde os blocos.
+ **/
+template <typename T>
+void structures::NodeArena<T>::splice(NodeArena& other) {
+    if (&other == this) {
+        return;
+    }
+
+    _size += other._size;
+    other._size = 0u;
+
+    if (other._chunks == nullptr) {  // Os nós da outra arena não estão em blocos
+        return;
+    }
+
+    // Junta as listas de blocos
+    Chunk* last = other._chunks;
+    while (last->next != nullptr) {
+        last = last->next;
+    }
+    last->next = _chunks;
+    _chunks = other._chunks;
+
+    // Junta as listas de espaços livres
+    if (other._free_list != nullptr) {
+        Slot* tail = other._free_list;
+        while (tail->next != nullptr) {
+            tail = tail->next;
+        }
+        tail->next = _free_list;
+        _free_list = other._free_list;
+    }
+
+    _chunk_count += other._chunk_count;
+
+    other._chunks = nullptr;
+    other._free_list = nullptr;
+    other._cursor = nullptr;
+    other._end = nullptr;
+    other._chunk_count = 0u;
+}
+
+/**
+ * Passa a contar nós que foram construídos fora dos blocos da arena, em uma memória de outro dono
+ * que vive mais que a arena. Cada nó deve ocupar um espaço de slot_size() bytes alinhado como o
+ * tipo, então um desses nós pode ser devolvido com deallocate e o seu espaço é reutilizado como
+ * o de qualquer nó devolvido. Por isso a arena passa a usar blocos, caso ainda não usasse.
+ *      Parâmetros:
+ *          count (std::size_t): Quantidade de nós.
+ **/
+template <typename T>
+void structures::NodeArena<T>::adopt(std::size_t count) {
+    _size += count;
+    _pooled = true;
+}
+
+/**
+ * Retorna verdadeiro caso os nós sejam alocados em blocos.
+ **/
+template <typename T>
+bool structures::NodeArena<T>::pooled() const {
+    return _pooled;
+}
+
+/**
+ * Retorna a quantidade de nós em uso (std::size_t).
+ **/
+template <typename T>
+std::size_t structures::NodeArena<T>::size() const {
+    return _size;
+}
+
+/**
+ * Retorna a quantidade de blocos alocados (std::size_t).
+ **/
+template <typename T>
+std::size_t structures::NodeArena<T>::chunk_count() const {
+    return _chunk_count;
+}
+
+/**
+ * Retorna a quantidade de nós por bloco (std::size_t).
+ **/
+template <typename T>
+std::size_t structures::NodeArena<T>::chunk_size() const {
+    return _chunk_size;
+}
+
+/**
+ * Retorna os bytes (std::size_t) ocupados pelos nós em uso.
+ **/
+template <typename T>
+std::size_t structures::NodeArena<T>::used_bytes() const {
+    return _size * sizeof(Slot);
+}
+
+/**
+ * Retorna os bytes (std::size_t) alocados em blocos, incluindo os cabeçalhos, os espaços livres
+ * e os espaços ainda não usados. Sem blocos são os bytes dos nós em uso.
+ **/
+template <typename T>
+std::size_t structures::NodeArena<T>::reserved_bytes() const {
+    if (!_pooled) {
+        return used_bytes();
+    }
+
+    const std::size_t header = (sizeof(Chunk) + sizeof(Slot) - 1) / sizeof(Slot);
+    return _chunk_count * (header + _chunk_size) * sizeof(Slot);
+}
+
+/**
+ * Retorna os bytes (std::size_t) do espaço de um nó, que é a distância entre dois nós de um bloco.
+ **/
+template <typename T>
+constexpr std::size_t structures::NodeArena<T>::slot_size() {
+    return sizeof(Slot);
+}
+
+/**
+ * Aloca um novo bloco. O cabeçalho e os espaços ficam em uma única alocação.
+ **/
+template <typename T>
+void structures::NodeArena<T>::grow() {
+    // O cabeçalho ocupa o espaço de um nó para manter o alinhamento dos demais
+    const std::size_t header = (sizeof(Chunk) + sizeof(Slot) - 1) / sizeof(Slot);
+    void* memory = std::malloc((header + _chunk_size) * sizeof(Slot));
+
+    if (memory == nullptr) {
+        throw std::out_of_range("Allocation Error");
+    }
+
+    Chunk* chunk = static_cast<Chunk*>(memory);
+    chunk->slots = reinterpret_cast<Slot*>(memory) + header;
+    chunk->next = _chunks;
+    _chunks = chunk;
+
+    _cursor = chunk->slots;
+    _end = chunk->slots + _chunk_size;
+    ++_chunk_count;
+}
+
+#endif
@@ -0,0 +1,184 @@
+// Copyright [2021] <Eric Fernandes Evaristo>
+// v1.0.1
+
+#ifndef STRUCTURES_OPERATION_STATS_H
+#define STRUCTURES_OPERATION_STATS_H
+
+#include <atomic>
+#include <chrono>     // std::chrono::steady_clock
+#include <cstdint>    // std::size_t, std::uint64_t
+#include <stdexcept>  // C++ exceptions
+
+namespace structures {
+
+// Classe LatencyHistogram, histograma de latências em faixas de potências de 2 nanossegundos.
+// Os contadores são atômicos, então pesquisas simultâneas em uma árvore constante podem
+// registrar as suas latências sem trava
+class LatencyHistogram {
+   public:
+    static const std::size_t BUCKETS = 40;  // Faixas (a última vai até cerca de 9 minutos)
+
+    // Construtor
+    LatencyHistogram();
+    // Registra uma ou mais operações com a mesma latência
+    void record(std::uint64_t nanoseconds, std::uint64_t count = 1);
+    // Zera o histograma
+    void reset();
+    // Retorna a quantidade de operações
+    std::uint64_t count() const;
+    // Retorna a soma das latências
+    std::uint64_t total_ns() const;
+    // Retorna a quantidade de operações de uma faixa
+    std::uint64_t bucket(std::size_t index) const;
+    // Retorna o limite superior da faixa que contém o percentil
+    std::uint64_t percentile(double percent) const;
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+   private:
+    std::atomic<std::uint64_t> _buckets[BUCKETS];  // Operações de cada faixa
+    std::atomic<std::uint64_t> _count;             // Quantidade de operações
+    std::atomic<std::uint64_t> _total;             // Soma das latências
+};
+
+// Histogramas de cada tipo de operação de uma árvore
+struct OperationStats {
+    LatencyHistogram insert;  // Inserções
+    LatencyHistogram search;  // Pesquisas (lookup, contains e as pesquisas derivadas)
+    LatencyHistogram remove;  // Remoções
+
+    /**
+     * Zera todos os histogramas.
+     **/
+    void reset() {
+        insert.reset();
+        search.reset();
+        remove.reset();
+    }
+};
+
+// Classe OperationTimer, mede o tempo de vida do objeto e o registra em um histograma
+class OperationTimer {
+   public:
+    /**
+     * Constrói um objeto structures::OperationTimer e começa a medida.
+     *      Parâmetros:
+     *          histogram: Histograma (LatencyHistogram&) que recebe a latência.
+     *          count: Quantidade (std::uint64_t) de operações medidas de uma vez.
+     **/
+    explicit OperationTimer(LatencyHistogram& histogram, std::uint64_t count = 1)
+        : _histogram(histogram), _count(count), _start(std::chrono::steady_clock::now()) {}
+
+    /**
+     * Destrói o objeto structures::OperationTimer e registra a latência média das operações.
+     **/
+    ~OperationTimer() {
+        if (_count > 0) {
+            std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - _start;
+            _histogram.record(static_cast<std::uint64_t>(elapsed.count()) / _count, _count);
+        }
+    }
+
+    OperationTimer(const OperationTimer&) = delete;
+    OperationTimer& operator=(const OperationTimer&) = delete;
+
+   private:
+    LatencyHistogram& _histogram;                  // Histograma da operação
+    std::uint64_t _count;                          // Operações medidas
+    std::chrono::steady_clock::time_point _start;  // Início da medida
+};
+
+}  // namespace structures
+
+/**
+ * Constrói um objeto structures::LatencyHistogram vazio.
+ **/
+inline structures::LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+/**
+ * Registra operações na faixa da latência. A faixa i contém as latências de 2^(i-1) até
+ * 2^i - 1 nanossegundos, e a faixa 0 contém as latências menores que 1 nanossegundo.
+ *      Parâmetros:
+ *          nanoseconds: Latência (std::uint64_t) de cada operação.
+ *          count: Quantidade (std::uint64_t) de operações.
+ **/
+inline void structures::LatencyHistogram::record(std::uint64_t nanoseconds, std::uint64_t count) {
+    std::size_t index = 0;
+    for (std::uint64_t rest = nanoseconds; rest != 0 && index < BUCKETS - 1; rest >>= 1) {
+        ++index;
+    }
+
+    _buckets[index].fetch_add(count, std::memory_order_relaxed);
+    _count.fetch_add(count, std::memory_order_relaxed);
+    _total.fetch_add(nanoseconds * count, std::memory_order_relaxed);
+}
+
+/**
+ * Zera o histograma.
+ **/
+inline void structures::LatencyHistogram::reset() {
+    for (std::size_t i = 0; i < BUCKETS; ++i) {
+        _buckets[i].store(0, std::memory_order_relaxed);
+    }
+    _count.store(0, std::memory_order_relaxed);
+    _total.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * Retorna a quantidade de operações registradas (std::uint64_t).
+ **/
+inline std::uint64_t structures::LatencyHistogram::count() const {
+    return _count.load(std::memory_order_relaxed);
+}
+
+/**
+ * Retorna a soma das latências registradas em nanossegundos (std::uint64_t).
+ **/
+inline std::uint64_t structures::LatencyHistogram::total_ns() const {
+    return _total.load(std::memory_order_relaxed);
+}
+
+/**
+ * Retorna a quantidade de operações (std::uint64_t) de uma faixa.
+ *      Parâmetros:
+ *          index: Índice (std::size_t) da faixa, menor que BUCKETS.
+ **/
+inline std::uint64_t structures::LatencyHistogram::bucket(std::size_t index) const {
+    if (index >= BUCKETS) {
+        throw std::out_of_range("Invalid bucket");
+    }
+
+    return _buckets[index].load(std::memory_order_relaxed);
+}
+
+/**
+ * Retorna o limite superior da faixa que contém o percentil, em nanossegundos.
+ *      Parâmetros:
+ *          percent: Percentil (double) de 0 a 100.
+ *      Retorno (std::uint64_t): Limite da faixa (0 caso não haja operações).
+ **/
+inline std::uint64_t structures::LatencyHistogram::percentile(double percent) const {
+    std::uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+
+    // Posição da operação do percentil, contando a partir de 1
+    std::uint64_t rank = static_cast<std::uint64_t>(percent / 100.0 * total + 0.5);
+    rank = rank < 1 ? 1 : (rank > total ? total : rank);
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < BUCKETS; ++i) {
+        seen += bucket(i);
+        if (seen >= rank) {
+            return i == 0 ? 0 : (std::uint64_t(1) << i) - 1;
+        }
+    }
+
+    return (std::uint64_t(1) << (BUCKETS - 1)) - 1;
+}
+
+#endif
@@ -4,27 +4,147 @@
 #ifndef STRUCTURES_PREFIX_TREE_H
 #define STRUCTURES_PREFIX_TREE_H
 
-#include <cstdint>    // std::size_t
+#include <sys/mman.h>  // mmap, madvise, munmap
+
+#include <algorithm>  // std::sort, std::min
+#include <atomic>
+#include <bitset>     // std::bitset
+#include <cstdint>    // std::size_t, std::uintptr_t
+#include <cstdlib>    // std::aligned_alloc, std::free
+#include <exception>  // std::exception_ptr
+#include <iterator>   // std::forward_iterator_tag
+#include <memory>     // std::unique_ptr
+#include <queue>      // std::priority_queue
 #include <stdexcept>  // C++ exceptions
 #include <string>
+#include <string_view>  // std::string_view
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>  // Comparação vetorial das chaves do Node16
+#endif
 
+#include "alphabet.h"
 #include "array_list.h"
+#include "lookup_result.h"
+#include "node_arena.h"
+#include "operation_stats.h"
+
+// Pede ao processador para trazer o endereço para o cache sem esperar a leitura
+#if defined(__GNUC__)
+#define PREFETCH(address) __builtin_prefetch(address)
+#else
+#define PREFETCH(address)
+#endif
 
-#define ASCII_OFFSET 97  // 97 é o código ascii da letra 'a'
+// Mede a operação do escopo em um histograma quando PREFIX_TREE_STATS está definido. Sem a
+// definição não há relógio nem contadores, e a árvore não guarda os histogramas
+#if defined(PREFIX_TREE_STATS)
+#define PREFIX_TREE_MEASURE(...) structures::OperationTimer operation_timer(__VA_ARGS__)
+#else
+#define PREFIX_TREE_MEASURE(...)
+#endif
 
 using std::string;
 
 namespace structures {
 
-// Classe PrefixTree, árvore de prefixos
+// Árvore em vetor duplo, definida em double_array_trie.h junto com PrefixTree::freeze e save
+class DoubleArrayTrie;
+// Autômato de busca em texto, definido em aho_corasick.h junto com PrefixTree::compile_scanner
+template <typename Alphabet>
+class AhoCorasick;
+// Árvore sucinta, definida em louds_trie.h junto com PrefixTree::succinct
+template <typename Alphabet>
+class LoudsTrie;
+// Autômato acíclico mínimo, definido em dawg.h junto com PrefixTree::minimize
+template <typename Alphabet>
+class Dawg;
+
+// Classe PrefixTree, árvore de prefixos. O alfabeto define quais bytes são letras, o índice de
+// cada letra e a quantidade máxima de filhos de um nó
+template <typename Alphabet = LowercaseAscii>
 class PrefixTree {
    public:
+    // Resultado de uma pesquisa completa de um prefixo
+    typedef structures::LookupResult LookupResult;
+
+    // Prefixo com os seus dados, usado na construção em bloco
+    struct Entry {
+        string prefix;             // Prefixo
+        unsigned long position;    // Posição do caractere no arquivo
+        unsigned long length;      // Comprimento da linha do prefixo
+        unsigned int weight = 0;   // Peso do prefixo, usado na ordenação de top_k
+    };
+
+    // Entry cujo prefixo é uma visão sobre um texto de outro dono (por exemplo um arquivo
+    // mapeado), que precisa existir durante a construção
+    struct EntryView {
+        std::string_view prefix;   // Prefixo
+        unsigned long position;    // Posição do caractere no arquivo
+        unsigned long length;      // Comprimento da linha do prefixo
+        unsigned int weight = 0;   // Peso do prefixo, usado na ordenação de top_k
+    };
+
+    // Prefixo encontrado pela pesquisa aproximada
+    struct FuzzyMatch {
+        string word;             // Prefixo escrito com os caracteres do alfabeto
+        unsigned long position;  // Posição do caractere no arquivo
+        unsigned long length;    // Comprimento da linha do prefixo
+        std::size_t distance;    // Distância de edição até a palavra pesquisada
+    };
+
+    // Prefixo encontrado por um padrão
+    struct PatternMatch {
+        string word;             // Prefixo escrito com os caracteres do alfabeto
+        unsigned long position;  // Posição do caractere no arquivo
+        unsigned long length;    // Comprimento da linha do prefixo
+    };
+
+    // Retrato da forma e da memória da árvore
+    struct Stats {
+        std::size_t prefixes = 0;                    // Quantidade de prefixos
+        std::size_t nodes = 0;                       // Quantidade de nós
+        std::size_t nodes_by_type[4] = {0, 0, 0, 0};  // Node4, Node16, Node48 e NodeFull
+        std::size_t bytes_in_use = 0;                // Bytes dos nós em uso e da raiz
+        std::size_t bytes_reserved = 0;              // Bytes alocados pelas arenas e da raiz
+        std::size_t child_slots = 0;                 // Espaços de filhos de todos os nós
+        std::size_t empty_slots = 0;                 // Espaços de filhos sem filho
+        std::size_t wasted_bytes = 0;                // Bytes dos espaços sem filho
+        std::size_t max_depth = 0;                   // Profundidade do nó mais fundo
+        std::vector<std::size_t> depth_histogram;    // Nós em cada profundidade (raiz: 1)
+        std::vector<std::size_t> fanout_histogram;   // Nós com cada quantidade de filhos
+    };
+
+    // Ordem dos nós abaixo dos níveis colocados em largura por relayout
+    enum LayoutOrder : unsigned char {
+        SUBTREE_CLUSTERED,  // Cada subárvore em profundidade, na ordem das letras
+        VAN_EMDE_BOAS       // Cada subárvore em van Emde Boas (metade de cima e depois as de baixo)
+    };
+
+    // Iterador que percorre os prefixos de uma subárvore em ordem alfabética
+    class CompletionIterator;
+    // Intervalo de prefixos que começam com um prefixo
+    class Completion;
+
     // Construtor
     PrefixTree();
+    // Construtor com parâmetro
+    explicit PrefixTree(std::size_t chunk_size);
     // Destrutor
     ~PrefixTree();
     // Insere um prefixo
-    void insert(const string& prefix, unsigned long position, unsigned long length);
+    void insert(std::string_view prefix, unsigned long position, unsigned long length,
+                unsigned int weight = 0);
+    // Insere prefixos em ordem alfabética em tempo linear
+    template <typename Iterator>
+    void build_sorted(Iterator begin, Iterator end);
+    // Insere prefixos construindo as subárvores da raiz em paralelo
+    template <typename Iterator>
+    void build_parallel(Iterator begin, Iterator end,
+                        unsigned threads = std::thread::hardware_concurrency());
     // Remove um prefixo
     void remove(const string& prefix);
     // Verifica se contém um prefixo
@@ -35,35 +155,86 @@ class PrefixTree {
     std::size_t size() const;
     // Retorna uma lista de prefixos em ordem alfabética
     ArrayList<string> aphabetical_order() const;
+    // Retorna os prefixos que começam com o prefixo, gerados sob demanda
+    Completion complete(const string& prefix) const;
+    // Retorna os k prefixos de maior peso que começam com o prefixo
+    ArrayList<string> top_k(const string& prefix, std::size_t k) const;
+    // Retorna os prefixos a no máximo uma distância de edição da palavra
+    ArrayList<FuzzyMatch> fuzzy_search(const string& word, std::size_t max_edits) const;
+    // Retorna os prefixos que correspondem a um padrão com '?', '*' e classes '[...]'
+    ArrayList<PatternMatch> match(const string& pattern) const;
+    // Retorna a quantidade de prefixos que correspondem a um padrão
+    unsigned long match_count(const string& pattern) const;
     // Retorna o número de prefixos contidos no prefixo do parâmetro
     unsigned long prefix_search(const string& prefix) const;
     // Retorna a posição do prefixo
     unsigned long position_search(const string& prefix) const;
     // Retorna o comprimento da linha do prefixo
     unsigned long length_search(const string& prefix) const;
+    // Retorna todos os dados do prefixo com uma única descida na árvore
+    LookupResult lookup(const string& prefix) const;
+    // Pesquisa vários prefixos de uma vez, intercalando as descidas
+    void lookup_batch(const string* prefixes, LookupResult* results, std::size_t count) const;
+    // Converte a árvore em uma árvore imutável em vetor duplo (double_array_trie.h)
+    DoubleArrayTrie freeze() const;
+    // Grava a árvore em um arquivo de índice (double_array_trie.h)
+    void save(const string& filename) const;
+    // Constrói o autômato que encontra os prefixos da árvore em um texto (aho_corasick.h)
+    AhoCorasick<Alphabet> compile_scanner() const;
+    // Converte a árvore em uma árvore sucinta (louds_trie.h)
+    LoudsTrie<Alphabet> succinct() const;
+    // Converte a árvore em um autômato acíclico mínimo (dawg.h)
+    Dawg<Alphabet> minimize() const;
+    // Reescreve todos os nós em uma única região contígua, na ordem das pesquisas
+    void relayout(std::size_t breadth_levels = 2, LayoutOrder order = SUBTREE_CLUSTERED,
+                  bool huge_pages = false);
+    // Retorna a forma e a memória da árvore
+    Stats stats() const;
+#if defined(PREFIX_TREE_STATS)
+    // Retorna os histogramas de latência das operações
+    const OperationStats& operations() const;
+    // Zera os histogramas de latência das operações
+    void reset_operations();
+#endif
 
    private:
-    // Estrutura de nó que descreve uma letra do prefixo
+    // Tipos de nó. O tipo é escolhido pela quantidade de filhos e muda automaticamente na
+    // inserção e na remoção
+    enum NodeType : unsigned char {
+        NODE4,    // Até 4 filhos com chaves ordenadas
+        NODE16,   // Até 16 filhos com chaves ordenadas (comparação vetorial)
+        NODE48,   // Até 48 filhos com um índice por letra (alfabetos com mais de 48 letras)
+        NODEFULL  // Um ponteiro para cada letra
+    };
+
+    struct NodePool;
+
+    // Estrutura de nó que descreve uma letra do prefixo. Os filhos ficam nos tipos derivados
     struct Node {
-        Node* _children[26];          // Vetor de ponteiros para cada letra
+        NodeType _type;               // Tipo do nó
+        std::uint16_t _child_count;   // Quantidade de filhos
+        unsigned int _weight;         // Peso do prefixo que termina neste nó
         unsigned long _position;      // Posição
         unsigned long _length;        // Comprimento
         unsigned long _prefix_count;  // Quantidade de prefixos contidos abaixo deste nó
+        unsigned int _max_weight;     // Maior peso entre os prefixos abaixo deste nó
 
         /**
          * Constrói uma estrutura structures::PrefixTree::Node.
          *      Parâmetros:
+         *          type: Tipo do nó.
          *          position: Posição do nó.
-         *          length: Altura da matriz.
+         *          length: Comprimento da linha do prefixo.
          **/
-        explicit Node(const unsigned long& position, const unsigned long& length) {
-            for (int i = 0; i < 26; ++i) {
-                _children[i] = nullptr;
-            }
-
+        explicit Node(NodeType type, const unsigned long& position,
+                      const unsigned long& length) {
+            _type = type;
+            _child_count = 0;
             _position = position;
             _length = length;
             _prefix_count = 0;
+            _weight = 0;
+            _max_weight = 0;
         }
 
         /**
@@ -91,6 +262,26 @@ class PrefixTree {
          **/
         unsigned long prefix_count() const { return _prefix_count; }
 
+        /**
+         * Retorna o peso (unsigned int) do prefixo que termina no nó.
+         **/
+        unsigned int weight() const { return _weight; }
+
+        /**
+         * Define o peso (unsigned int) do prefixo que termina no nó.
+         **/
+        void weight(unsigned int weight) { _weight = weight; }
+
+        /**
+         * Retorna o maior peso (unsigned int) entre os prefixos abaixo do nó.
+         **/
+        unsigned int max_weight() const { return _max_weight; }
+
+        /**
+         * Recalcula o maior peso a partir do peso do nó e do maior peso de cada filho.
+         **/
+        void update_max_weight();
+
         /**
          * Incrementa a quantidade de prefixos abaixo do nó.
          **/
@@ -102,421 +293,2102 @@ class PrefixTree {
         void decrease_prefix_count() { --_prefix_count; }
 
         /**
-         * Insere o prefixo de forma recursiva. Cada caractere corresponde a um nó.
+         * Procura o espaço do filho de uma letra.
          *      Parâmetros:
-         *          prefix: Prefíxo (string) a ser inserido.
-         *          position: Posição (unsigned long) do caractere no arquivo.
-         *          length: Comprimento (unsigned long) da linha do prefixo.
-         *          index: Índice (std::size_t) do caractere que será inserido no nó.
-         **/
-        void insert(const string& prefix, const unsigned long& position,
-                    const unsigned long& length, const std::size_t& index) {
-            // Observação: Esse método é chamado no nó que irá inserir os dados no nó abaixo dele
-
-            // Verifica se o índice é maior que o prefixo, caso seja isso significa que o prefixo
-            // deve ser inserido no próprio nó em que este método foi chamado. Caso contrário faz
-            // a inserção normal
-            if (index < prefix.length()) {
-                // Caso o caractere não tenha sido inserido em um nó ainda ele será criado
-                if (_children[prefix[index] - ASCII_OFFSET] == nullptr) {
-                    // Cria um novo nó para representar o caractere
-                    _children[prefix[index] - ASCII_OFFSET] = new Node(position, length);
-
-                    // Verifica se a alocação foi bem sucedida
-                    if (_children[prefix[index] - ASCII_OFFSET] != nullptr) {
-                        // Caso o nó criado corresponda a um caractere intermediário do prefixo ele
-                        // terá os seus dados zerados e a inserção do próximo caractere será
-                        // chamada. Caso contrário o nó corresponde ao último caractere do prefixo,
-                        // sendo assim a inserção se encerra e o número de prefixos contidos por
-                        // aquele nó será incrementado
-                        if (index < prefix.length() - 1) {
-                            _children[prefix[index] - ASCII_OFFSET]->position(0);
-                            _children[prefix[index] - ASCII_OFFSET]->length(0);
-                            _children[prefix[index] - ASCII_OFFSET]->insert(prefix, position,
-                                                                            length, index + 1);
-                        } else {
-                            _children[prefix[index] - ASCII_OFFSET]->increase_prefix_count();
-                        }
-                    } else {
-                        throw std::out_of_range("Allocation Error");
-                    }
+         *          key: Índice (unsigned char) da letra.
+         *      Retorno (Node**): Espaço que guarda o filho (nullptr caso não exista).
+         **/
+        Node** find_child(unsigned char key);
 
-                } else {  // Caso o caractere já exista chama a inserção no próximo nó
-                    _children[prefix[index] - ASCII_OFFSET]->insert(prefix, position, length,
-                                                                    index + 1);
-                }
-            } else {
-                _position = position;
-                _length = length;
+        /**
+         * Retorna o filho de uma letra (nullptr caso não exista).
+         *      Parâmetros:
+         *          key: Índice (unsigned char) da letra.
+         **/
+        const Node* child(unsigned char key) const {
+            Node* const* slot = const_cast<Node*>(this)->find_child(key);
+            return slot != nullptr ? *slot : nullptr;
+        }
+
+        /**
+         * Chama a função para cada filho em ordem alfabética.
+         *      Parâmetros:
+         *          function: Função que recebe o índice da letra e o filho.
+         **/
+        template <typename Function>
+        void for_each_child(Function function) const;
+
+        /**
+         * Adiciona um filho. Caso o nó esteja cheio ele é trocado por um nó maior e o
+         * ponteiro que o referencia é atualizado.
+         *      Parâmetros:
+         *          ref: Ponteiro (Node*&) que referencia o nó.
+         *          key: Índice (unsigned char) da letra do filho.
+         *          child: Filho (Node*) a ser adicionado.
+         *          pool: Conjunto de arenas (NodePool) de onde os nós são alocados.
+         *      Retorno (Node**): Espaço que guarda o filho adicionado.
+         **/
+        static Node** add_child(Node*& ref, unsigned char key, Node* child, NodePool& pool);
+
+        /**
+         * Remove um filho. Caso o nó fique com poucos filhos ele é trocado por um nó menor e o
+         * ponteiro que o referencia é atualizado.
+         *      Parâmetros:
+         *          ref: Ponteiro (Node*&) que referencia o nó.
+         *          key: Índice (unsigned char) da letra do filho.
+         *          pool: Conjunto de arenas (NodePool) que recebe os nós trocados.
+         **/
+        static void remove_child(Node*& ref, unsigned char key, NodePool& pool);
+
+        /**
+         * Remove o prefixo de forma recursiva. Cada letra corresponde a um nó e os nós que
+         * ficarem sem prefixos são devolvidos para a arena.
+         *      Parâmetros:
+         *          ref: Ponteiro (Node*&) que referencia o nó (nulo caso o nó seja deletado).
+         *          keys: Índices (string) das letras do prefixo a ser removido.
+         *          index: Posição (std::size_t) da próxima letra do prefixo.
+         *          pool: Conjunto de arenas (NodePool) que recebe os nós deletados.
+         **/
+        static void remove(Node*& ref, const string& keys, const std::size_t& index,
+                           NodePool& pool);
+
+        /**
+         * Retorna o próximo filho em ordem alfabética a partir de uma posição e avança a
+         * posição para depois dele.
+         *      Parâmetros:
+         *          slot: Posição (std::size_t&) da busca, começando em 0.
+         *          key: Índice (unsigned char&) da letra do filho encontrado.
+         *      Retorno (const Node*): Filho encontrado (nullptr caso não existam mais filhos).
+         **/
+        const Node* next_child(std::size_t& slot, unsigned char& key) const;
+    };
+
+    // Nó com até 4 filhos. As chaves ficam ordenadas e a busca é linear
+    struct Node4 : Node {
+        unsigned char _keys[4];  // Índices das letras dos filhos
+        Node* _children[4];      // Filhos na mesma ordem das chaves
+
+        explicit Node4(const unsigned long& position, const unsigned long& length)
+            : Node(NODE4, position, length) {}
+    };
+
+    // Nó com até 16 filhos. As chaves ficam ordenadas e são comparadas de uma só vez com SSE2
+    struct Node16 : Node {
+        unsigned char _keys[16];  // Índices das letras dos filhos
+        Node* _children[16];      // Filhos na mesma ordem das chaves
+
+        explicit Node16(const unsigned long& position, const unsigned long& length)
+            : Node(NODE16, position, length) {}
+    };
+
+    // Nó com até 48 filhos. Cada letra guarda a posição do filho mais um (0 caso não exista),
+    // então o nó ocupa uma fração de um NodeFull nos alfabetos grandes
+    struct Node48 : Node {
+        unsigned char _index[Alphabet::SIZE];  // Posição do filho de cada letra mais um
+        Node* _children[48];                   // Filhos (nullptr nas posições livres)
+
+        explicit Node48(const unsigned long& position, const unsigned long& length)
+            : Node(NODE48, position, length) {
+            for (std::size_t i = 0; i < Alphabet::SIZE; ++i) {
+                _index[i] = 0;
+            }
+            for (std::size_t i = 0; i < 48; ++i) {
+                _children[i] = nullptr;
+            }
+        }
+    };
+
+    // Nó com um ponteiro para cada letra, usado apenas quando há muitos filhos
+    struct NodeFull : Node {
+        Node* _children[Alphabet::SIZE];  // Vetor de ponteiros para cada letra
+
+        explicit NodeFull(const unsigned long& position, const unsigned long& length)
+            : Node(NODEFULL, position, length) {
+            for (std::size_t i = 0; i < Alphabet::SIZE; ++i) {
+                _children[i] = nullptr;
             }
+        }
+    };
+
+    // Conjunto de arenas, uma para cada tipo de nó
+    struct NodePool {
+        // Memória contígua com nós de todos os tipos, criada por relayout
+        struct Region {
+            void* memory;       // Início da alocação
+            std::size_t bytes;  // Tamanho da alocação
+            bool mapped;        // Indica se a memória foi mapeada (senão, foi alocada)
+            char* begin;        // Primeiro nó (alinhado dentro da alocação)
+        };
 
-            increase_prefix_count();  // Incrementa a contagem de prefixos contidos pelo nó
+        NodeArena<Node4> _arena4;        // Arena dos nós de 4 filhos
+        NodeArena<Node16> _arena16;      // Arena dos nós de 16 filhos
+        NodeArena<Node48> _arena48;      // Arena dos nós de 48 filhos
+        NodeArena<NodeFull> _arenafull;  // Arena dos nós com um filho por letra
+        std::vector<Region> _regions;    // Regiões com nós fora das arenas
+
+        // Com chunk_size 0 cada nó é uma alocação própria, sem blocos
+        explicit NodePool(std::size_t chunk_size)
+            : _arena4(chunk_size, chunk_size > 0),
+              _arena16(chunk_size, chunk_size > 0),
+              _arena48(chunk_size, chunk_size > 0),
+              _arenafull(chunk_size, chunk_size > 0) {}
+
+        ~NodePool() { release_regions(); }
+
+        NodePool(const NodePool&) = delete;
+        NodePool& operator=(const NodePool&) = delete;
+
+        /**
+         * Retorna os bytes (std::size_t) do espaço de um nó do tipo, o mesmo das arenas.
+         **/
+        static std::size_t slot_size(NodeType type) {
+            switch (type) {
+                case NODE4:
+                    return NodeArena<Node4>::slot_size();
+                case NODE16:
+                    return NodeArena<Node16>::slot_size();
+                case NODE48:
+                    return NodeArena<Node48>::slot_size();
+                default:
+                    return NodeArena<NodeFull>::slot_size();
+            }
         }
 
         /**
-         * Remove o prefixo de forma recursiva. Cada caractere corresponde a um nó.
+         * Aloca uma região alinhada à linha de cache. Com páginas grandes a região é mapeada
+         * com folga para começar em um limite de 2 MiB, e o kernel é avisado com
+         * MADV_HUGEPAGE (quando o sistema não tem o aviso, a região usa páginas comuns).
          *      Parâmetros:
-         *          prefix: Prefíxo (string) a ser removido.
-         *          index: Índice (std::size_t) do caractere que será removido.
-         *      Retorno (bool): valor que indica se o nó abaixo foi deletado (verdadeiro) ou foi
-         *      apenas zerado (falso).
-         **/
-        bool remove(const string& prefix, const std::size_t& index) {
-            // Os nós que não tiverem filhos serão deletados, mas os nós que tiverem algum filho só
-            // terão os seus dados apagados. Esse método só funciona se o prefixo existir e não pode
-            // ser chamado antes da verificação da presença do nó
-            if (index < prefix.length() - 1) {  // Caso o nó filho não seja o alvo de deleção
-                bool deleted_node;              // Condição de deleção
-                // Chama a remoção no nó filho
-                deleted_node = _children[prefix[index] - ASCII_OFFSET]->remove(prefix, index + 1);
-
-                if (deleted_node == true) {     // Se o nó filho foi deletado
-                    if (prefix_count() == 1) {  // Se esse nó só possui um prefixo abaixo dele
-                        // Este nó se deleta e retorna verdadeiro para a condição de deleção
-                        delete this;
-                        return true;
-                    }
+         *          bytes: Tamanho (std::size_t) mínimo da região.
+         *          huge_pages: Indica se a região deve usar páginas grandes.
+         *      Retorno (Region): Região alocada.
+         **/
+        static Region allocate_region(std::size_t bytes, bool huge_pages) {
+            Region region = {nullptr, 0, false, nullptr};
+
+            if (huge_pages) {
+                const std::size_t huge = std::size_t(2) << 20;
+                std::size_t size = (bytes + huge - 1) / huge * huge + huge;
+                void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (memory == MAP_FAILED) {
+                    throw std::out_of_range("Allocation Error");
                 }
-            } else if (index == prefix.length() - 1) {  // Caso o nó filho seja o alvo de deleção
-                // Caso o nó filho possua só um prefixo abaixo dele ele será deletado, caso
-                // contrário os dados serão apenas apagados
-                if (_children[prefix[index] - ASCII_OFFSET]->prefix_count() == 1) {
-                    delete _children[prefix[index] - ASCII_OFFSET];     // Deleta o nó filho
-                    _children[prefix[index] - ASCII_OFFSET] = nullptr;  // Define o filho como nulo
-
-                    // Caso esse nó não seja um prefixo e não contenha mais que um prefixo abaixo
-                    // dele ele irá deletar a si mesmo e retornar verdadeiro para a condição de
-                    // deleção
-                    if (length() == 0 && prefix_count() == 1) {
-                        delete this;
-                        return true;
-                    }
-                } else {
-                    // Apaga os dados do nó filho e reduz a contagem de prefixos naquele nó
-                    _children[prefix[index] - ASCII_OFFSET]->position(0);
-                    _children[prefix[index] - ASCII_OFFSET]->length(0);
-                    _children[prefix[index] - ASCII_OFFSET]->decrease_prefix_count();
+
+                std::uintptr_t address = reinterpret_cast<std::uintptr_t>(memory);
+                std::uintptr_t aligned = (address + huge - 1) / huge * huge;
+                region = {memory, size, true, reinterpret_cast<char*>(aligned)};
+#if defined(MADV_HUGEPAGE)
+                madvise(region.begin, size - (aligned - address), MADV_HUGEPAGE);
+#endif
+            } else {
+                const std::size_t line = 64;
+                std::size_t size = (bytes + line - 1) / line * line;
+                void* memory = std::aligned_alloc(line, size > 0 ? size : line);
+                if (memory == nullptr) {
+                    throw std::out_of_range("Allocation Error");
                 }
-            } else {  // Caso o nó a ser deletado seja este nó
-                // Este nó se deleta e retorna verdadeiro para a condição de deleção
-                delete this;
-                return true;
+
+                region = {memory, size, false, static_cast<char*>(memory)};
             }
 
-            decrease_prefix_count();  // Decrementa a contagem de prefixos incluídos
-            return false;             // Retorna falso para a condição de deleção
+            return region;
         }
 
         /**
-         * Verifica se o prefixo está contido de forma recursiva.
+         * Libera uma região. Os nós dela se tornam inválidos.
          *      Parâmetros:
-         *          prefix: Prefíxo (string) a ser verificado.
-         *          index: Índice (std::size_t) do caractere que será verificado.
-         *      Retorno (bool): valor que indica se o fim do prefixo foi encontrado ou não.
-         **/
-        bool contains(const string& prefix, const std::size_t& index) const {
-            // Caminha pelos nós e verifica se o nó final possui um comprimento diferente de 0
-            if (index < prefix.length() - 1) {  // O nó procurado está abaixo do filho
-                // Verifica se o nó filho não é nulo
-                if (_children[prefix[index] - ASCII_OFFSET] != nullptr) {
-                    // Procura no nó filho
-                    return _children[prefix[index] - ASCII_OFFSET]->contains(prefix, index + 1);
-                }
-            } else if (index == prefix.length() - 1) {  // O nó procurado é o filho
-                // Verifica se o nó filho não é nulo
-                if (_children[prefix[index] - ASCII_OFFSET] != nullptr) {
-                    // Verifica se o filho tem um comprimento diferente de 0 (é prefixo) e retorna
-                    // verdadeiro caso tenha
-                    if (_children[prefix[index] - ASCII_OFFSET]->length() != 0) {
-                        return true;
-                    }
-                }
-            } else {  // Caso o nó procurado seja este
-                // Verifica se este nó tem um comprimento diferente de 0 (é prefixo) e retorna
-                // verdadeiro caso tenha
-                if (length() != 0) {
-                    return true;
-                }
+         *          region: Região (Region&) a ser liberada.
+         **/
+        static void release_region(Region& region) {
+            if (region.mapped) {
+                munmap(region.memory, region.bytes);
+            } else {
+                std::free(region.memory);
             }
+            region = {nullptr, 0, false, nullptr};
+        }
 
-            return false;  // Nó não encontrado
+        /**
+         * Libera todas as regiões.
+         **/
+        void release_regions() {
+            for (Region& region : _regions) {
+                release_region(region);
+            }
+            _regions.clear();
         }
 
         /**
-         * Retorna uma lista com todos os prefixos abaixo deste nó (recursivamente).
+         * Troca todos os nós pelos nós de uma região. As arenas e as regiões anteriores são
+         * liberadas e as arenas passam a contar os nós da região, que podem ser devolvidos a
+         * elas como qualquer nó.
          *      Parâmetros:
-         *          prefix: Prefíxo (string) que está sendo construído.
-         *          list: Lista (ArrayList<string>) com os prefixos.
-         *          index: Índice (std::size_t) do caractere que será adicionado.
-         *      Retorno (ArrayList<string>): Lista com os prefixos em ordem alfabética.
-         **/
-        void alphabetical_order(const string& prefix, ArrayList<string>& list,
-                                const std::size_t& index) const {
-            // Cria um novo string para o prefixo. Essa cópia é feita para permitir a ramificação
-            // dos prefixos com diferentes origens
-            string new_prefix(prefix);
-            // Adiciona o caractere deste nó no prefixo
-            new_prefix.push_back(char(index + ASCII_OFFSET));
-
-            // Se o este nó é o fim de um prefixo, adiciona o prefixo na lista
-            if (length() != 0) {
-                list.push_back(new_prefix);
-            }
-
-            // Procura por nós filhos e chama o método recursivamente
-            for (int i = 0; i < 26; ++i) {
-                if (_children[i] != nullptr) {
-                    _children[i]->alphabetical_order(new_prefix, list, i);
-                }
+         *          region: Região (const Region&) com os nós.
+         *          counts: Quantidade (const std::size_t*) de nós de cada tipo na região.
+         **/
+        void adopt(const Region& region, const std::size_t* counts) {
+            clear();
+            _regions.push_back(region);
+
+            _arena4.adopt(counts[NODE4]);
+            _arena16.adopt(counts[NODE16]);
+            _arena48.adopt(counts[NODE48]);
+            _arenafull.adopt(counts[NODEFULL]);
+        }
+
+        /**
+         * Retorna os bytes (std::size_t) alocados em regiões.
+         **/
+        std::size_t region_bytes() const {
+            std::size_t bytes = 0;
+            for (const Region& region : _regions) {
+                bytes += region.bytes;
             }
+            return bytes;
         }
 
         /**
-         * Retorna o número de prefixos abaixo do nó (recursivamente).
+         * Aloca um nó vazio do tipo.
          *      Parâmetros:
-         *          prefix: Prefíxo (string) que está sendo procurado.
-         *          index: Índice (std::size_t) do caractere do prefixo.
-         *      Retorno (unsigned long): Número de prefixos contidos abaixo do nó.
-         **/
-        unsigned long prefix_search(const string& prefix, const std::size_t& index) {
-            // Este método caminha entre os nós até encontrar o último caractere do prefixo ou até
-            // que acabem os nós no caminho feito
-            if (index < prefix.length() - 1) {  // Caso o nó filho não seja o procurado
-                // Verifica se o filho não é nulo e chama a pesquisa recursivamente
-                if (_children[prefix[index] - ASCII_OFFSET] != nullptr) {
-                    return _children[prefix[index] - ASCII_OFFSET]->prefix_search(prefix,
-                                                                                  index + 1);
-                }
-            } else if (index == prefix.length() - 1) {  // Caso o nó filho seja o procurado
-                // Verifica se o filho não é nulo e obtém o valor de prefixos contidos no filho
-                if (_children[prefix[index] - ASCII_OFFSET] != nullptr) {
-                    return _children[prefix[index] - ASCII_OFFSET]->prefix_count();
-                }
-            } else {  // Caso este nó seja o procurado (Caso que o prefixo tem só um caractere)
-                return prefix_count();  // Retorna a quantidade de prefixos contidos neste prefixo
+         *          type: Tipo do nó.
+         *      Retorno (Node*): Nó alocado.
+         **/
+        Node* allocate(NodeType type) {
+            switch (type) {
+                case NODE4:
+                    return _arena4.allocate(0, 0);
+                case NODE16:
+                    return _arena16.allocate(0, 0);
+                case NODE48:
+                    return _arena48.allocate(0, 0);
+                default:
+                    return _arenafull.allocate(0, 0);
             }
-
-            return 0;  // Caso o prefixo procurado não tenha sido encontrado
         }
 
         /**
-         * Retorna a posição do nó encontrado na pesquisa (recursivamente).
+         * Devolve o nó para a arena do seu tipo.
          *      Parâmetros:
-         *          prefix: Prefíxo (string) que está sendo procurado.
-         *          index: Índice (std::size_t) do caractere do prefixo.
-         *      Retorno (unsigned long): Posição do nó encontrado (-1 caso não seja encontrado).
-         **/
-        unsigned long position_search(const string& prefix, const std::size_t& index) {
-            // Este método caminha entre os nós até encontrar o último caractere do prefixo ou até
-            // que acabem os nós no caminho feito
-            if (index < prefix.length() - 1) {  // Caso o nó filho não seja o procurado
-                // Verifica se o filho não é nulo e chama a pesquisa recursivamente
-                if (_children[prefix[index] - ASCII_OFFSET] != nullptr) {
-                    return _children[prefix[index] - ASCII_OFFSET]->position_search(prefix,
-                                                                                    index + 1);
-                }
-            } else if (index == prefix.length() - 1) {  // Caso o nó filho seja o procurado
-                // Verifica se o filho não é nulo
-                if (_children[prefix[index] - ASCII_OFFSET] != nullptr) {
-                    // Verifica se o filho tem um comprimento diferente de 0 (é o fim de um prefixo)
-                    if (_children[prefix[index] - ASCII_OFFSET]->length() != 0) {
-                        // Retorna a posição do filho
-                        return _children[prefix[index] - ASCII_OFFSET]->position();
-                    }
-                }
-            } else if (length() != 0) {  // Caso este nó seja o procurado e seja o fim de um prefixo
-                return position();       // Retorna a posição
+         *          node: Nó (Node*) a ser devolvido.
+         **/
+        void deallocate(Node* node) {
+            switch (node->_type) {
+                case NODE4:
+                    _arena4.deallocate(static_cast<Node4*>(node));
+                    break;
+                case NODE16:
+                    _arena16.deallocate(static_cast<Node16*>(node));
+                    break;
+                case NODE48:
+                    _arena48.deallocate(static_cast<Node48*>(node));
+                    break;
+                default:
+                    _arenafull.deallocate(static_cast<NodeFull*>(node));
+                    break;
             }
+        }
+
+        /**
+         * Retorna verdadeiro caso os nós sejam alocados em blocos. Todas as arenas usam o mesmo
+         * modo.
+         **/
+        bool pooled() const { return _arena4.pooled(); }
+
+        /**
+         * Retorna a quantidade (std::size_t) de nós por bloco (0 caso os nós não usem blocos).
+         **/
+        std::size_t chunk_size() const { return pooled() ? _arena4.chunk_size() : 0u; }
+
+        /**
+         * Retorna a quantidade (std::size_t) de nós em uso.
+         **/
+        std::size_t size() const {
+            return _arena4.size() + _arena16.size() + _arena48.size() + _arenafull.size();
+        }
+
+        /**
+         * Toma todos os nós de outro conjunto de arenas.
+         *      Parâmetros:
+         *          other: Conjunto (NodePool) que perde os nós.
+         **/
+        void splice(NodePool& other) {
+            _arena4.splice(other._arena4);
+            _arena16.splice(other._arena16);
+            _arena48.splice(other._arena48);
+            _arenafull.splice(other._arenafull);
+            _regions.insert(_regions.end(), other._regions.begin(), other._regions.end());
+            other._regions.clear();
+        }
+
+        /**
+         * Libera todos os nós de uma só vez.
+         **/
+        void clear() {
+            _arena4.clear();
+            _arena16.clear();
+            _arena48.clear();
+            _arenafull.clear();
+            release_regions();
+        }
+    };
 
-            return 0;  // Caso o prefixo procurado não tenha sido encontrado
+    // Iterador sobre iteradores de Entry, usado para construir as partes sem copiar os prefixos
+    template <typename Iterator>
+    struct IndirectIterator {
+        typename std::vector<Iterator>::const_iterator _it;  // Posição na parte
+
+        auto operator->() const -> decltype(&**_it) { return &**_it; }
+        IndirectIterator& operator++() {
+            ++_it;
+            return *this;
         }
+        bool operator!=(const IndirectIterator& other) const { return _it != other._it; }
+    };
+
+    // Lê os índices das letras de um prefixo, pulando os bytes que o alfabeto ignora
+    struct KeyReader {
+        std::string_view _text;  // Prefixo
+        std::size_t _next;       // Próximo byte a ser lido
+
+        explicit KeyReader(std::string_view text = std::string_view()) : _text(text), _next(0) {}
 
         /**
-         * Retorna o comprimento do nó encontrado na pesquisa (recursivamente).
+         * Lê o índice da próxima letra.
          *      Parâmetros:
-         *          prefix: Prefíxo (string) que está sendo procurado.
-         *          index: Índice (std::size_t) do caractere do prefixo.
-         *      Retorno (unsigned long): Comprimento do nó encontrado (0 caso não seja encontrado).
-         **/
-        unsigned long length_search(const string& prefix, const std::size_t& index) {
-            // Este método caminha entre os nós até encontrar o último caractere do prefixo ou até
-            // que acabem os nós no caminho feito
-            if (index < prefix.length() - 1) {  // Caso o nó filho não seja o procurado
-                // Verifica se o filho não é nulo e chama a pesquisa recursivamente
-                if (_children[prefix[index] - ASCII_OFFSET] != nullptr) {
-                    return _children[prefix[index] - ASCII_OFFSET]->length_search(prefix,
-                                                                                  index + 1);
+         *          key: Índice (int&) da letra, ou AlphabetIndex::INVALID caso o byte não
+         *              pertença ao alfabeto.
+         *      Retorno (bool): Falso caso o prefixo tenha acabado.
+         **/
+        bool next(int& key) {
+            while (_next < _text.size()) {
+                key = Alphabet::index(static_cast<unsigned char>(_text[_next++]));
+                if (key != AlphabetIndex::SKIP) {
+                    return true;
                 }
-            } else if (index == prefix.length() - 1) {  // Caso o nó filho seja o procurado
-                // Caso o filho não seja nulo, retorna o comprimento do filho
-                if (_children[prefix[index] - ASCII_OFFSET] != nullptr) {
-                    return _children[prefix[index] - ASCII_OFFSET]->length();
+            }
+            return false;
+        }
+    };
+
+    // Padrão compilado em um autômato finito não determinístico. O estado i espera o item i do
+    // padrão e o último estado aceita. Um conjunto de estados é um vetor com uma marca por estado
+    struct Pattern {
+        // Item do padrão: uma letra de um conjunto, ou qualquer sequência de letras ('*')
+        struct Item {
+            bool star;                            // Aceita qualquer sequência, inclusive vazia
+            std::bitset<Alphabet::SIZE> letters;  // Letras aceitas (quando não é '*')
+        };
+
+        std::vector<Item> _items;      // Itens em ordem
+        std::vector<bool> _universal;  // O estado aceita qualquer continuação
+
+        // Compila o padrão
+        explicit Pattern(std::string_view text);
+
+        /**
+         * Retorna a quantidade de estados (std::size_t), incluindo o estado que aceita.
+         **/
+        std::size_t states() const { return _items.size() + 1; }
+
+        // Preenche o conjunto inicial
+        void start(unsigned char* set) const;
+        // Calcula o conjunto depois de uma letra
+        bool step(const unsigned char* from, unsigned char key, unsigned char* to) const;
+        // Retorna a única letra que algum estado do conjunto aceita
+        int single(const unsigned char* set) const;
+
+        /**
+         * Retorna verdadeiro caso o conjunto contenha o estado que aceita.
+         **/
+        bool accepts(const unsigned char* set) const { return set[_items.size()] != 0; }
+
+        /**
+         * Retorna verdadeiro caso algum estado do conjunto ainda espere letras.
+         **/
+        bool live(const unsigned char* set) const {
+            for (std::size_t i = 0; i < _items.size(); ++i) {
+                if (set[i] != 0) {
+                    return true;
                 }
-            } else {              // Caso este nó seja o procurado
-                return length();  // Retorna o comprimento
             }
+            return false;
+        }
 
-            return 0;  // Caso o prefixo procurado não tenha sido encontrado
+        /**
+         * Retorna verdadeiro caso o conjunto aceite qualquer continuação, ou seja, caso todos
+         * os prefixos da subárvore correspondam ao padrão.
+         **/
+        bool universal(const unsigned char* set) const {
+            for (std::size_t i = 0; i < _items.size(); ++i) {
+                if (set[i] != 0 && _universal[i]) {
+                    return true;
+                }
+            }
+            return false;
         }
+
+       private:
+        // Marca os estados alcançados sem consumir letras (os '*' podem ficar vazios)
+        void close(unsigned char* set) const;
+        // Lê a próxima letra do texto do padrão
+        static int next_letter(std::string_view text, std::size_t& i);
+    };
+
+    // Converte o prefixo nos índices das suas letras
+    static bool to_keys(std::string_view prefix, string& keys);
+    // Percorre os nós que correspondem a um padrão
+    template <typename Visit>
+    void walk(const Pattern& pattern, bool whole_subtrees, Visit visit) const;
+    // Pesquisa o prefixo sem registrar a operação
+    LookupResult descend(const string& prefix) const;
+
+    Node* _root[Alphabet::SIZE];  // Raiz
+    std::size_t _size;            // Tamanho da árvore
+    NodePool _pool;               // Arenas que guardam todos os nós
+#if defined(PREFIX_TREE_STATS)
+    mutable OperationStats _operations;  // Latências das operações
+#endif
+
+    static const std::size_t DEFAULT_CHUNK_SIZE = 4096u;
+    static const std::size_t BATCH_GROUP = 16u;  // Pesquisas intercaladas de uma vez
+
+    static_assert(Alphabet::SIZE >= 1 && Alphabet::SIZE <= 256,
+                  "O alfabeto precisa ter de 1 a 256 letras");
+};
+
+// Iterador que percorre os prefixos de uma subárvore em ordem alfabética. A descida usa uma
+// pilha explícita e o prefixo atual fica em um único string que é reaproveitado, então avançar
+// não aloca memória por prefixo
+template <typename Alphabet>
+class PrefixTree<Alphabet>::CompletionIterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef string value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const string* pointer;
+    typedef const string& reference;
+
+    // Construtor do iterador final
+    CompletionIterator();
+    // Retorna o prefixo atual
+    const string& operator*() const { return _word; }
+    const string* operator->() const { return &_word; }
+    // Retorna a posição do prefixo atual
+    unsigned long position() const { return _stack.back().node->position(); }
+    // Retorna o comprimento da linha do prefixo atual
+    unsigned long length() const { return _stack.back().node->length(); }
+    // Avança para o próximo prefixo
+    CompletionIterator& operator++();
+    CompletionIterator operator++(int);
+    bool operator==(const CompletionIterator& other) const;
+    bool operator!=(const CompletionIterator& other) const { return !(*this == other); }
+
+   private:
+    friend class PrefixTree;
+
+    // Nó na pilha de descida e a posição do próximo filho a ser visitado
+    struct Frame {
+        const Node* node;    // Nó (nullptr para a raiz da árvore)
+        std::size_t slot;    // Posição do próximo filho
     };
 
-    Node* _root[26];    // Raiz
-    std::size_t _size;  // Tamanho da árvore
+    Node* const* _root;         // Filhos da raiz da árvore
+    std::vector<Frame> _stack;  // Caminho do nó base até o nó atual
+    string _word;               // Prefixo do nó atual
+
+    // Constrói o iterador no primeiro prefixo abaixo do nó base
+    CompletionIterator(Node* const* root, const Node* base, const string& prefix);
+    // Desce até o próximo nó que é o fim de um prefixo
+    void advance();
+};
+
+// Intervalo de prefixos que começam com um prefixo, percorrido por CompletionIterator
+template <typename Alphabet>
+class PrefixTree<Alphabet>::Completion {
+   public:
+    typedef CompletionIterator iterator;
+    typedef CompletionIterator const_iterator;
+
+    CompletionIterator begin() const { return _begin; }
+    CompletionIterator end() const { return CompletionIterator(); }
+
+   private:
+    friend class PrefixTree;
+
+    explicit Completion(CompletionIterator begin) : _begin(std::move(begin)) {}
+
+    CompletionIterator _begin;  // Primeiro prefixo do intervalo
 };
 
 }  // namespace structures
 
 /**
- * Constrói um objeto structures::PrefixTree.
+ * Constrói o iterador final, que não aponta para nenhum prefixo.
  **/
-structures::PrefixTree::PrefixTree() {
-    // Inicializa os atributos
-    for (int i = 0; i < 26; ++i) {
-        _root[i] = nullptr;
-    }
-
-    _size = 0u;
-}
+template <typename Alphabet>
+inline structures::PrefixTree<Alphabet>::CompletionIterator::CompletionIterator()
+    : _root(nullptr) {}
 
 /**
- * Destrói o objeto structures::PrefixTree.
+ * Constrói o iterador no primeiro prefixo abaixo do nó base (inclusive).
+ *      Parâmetros:
+ *          root: Filhos (Node* const*) da raiz da árvore.
+ *          base: Nó (const Node*) do prefixo pesquisado (nullptr para a raiz).
+ *          prefix: Prefíxo (string) do nó base.
  **/
-structures::PrefixTree::~PrefixTree() {
-    // Gera uma lista com todos os prefixos e remove todos eles
-    structures::ArrayList<string> list = aphabetical_order();
-    for (std::size_t i = 0; i < list.size(); ++i) {
-        remove(list.at(i));
+template <typename Alphabet>
+inline structures::PrefixTree<Alphabet>::CompletionIterator::CompletionIterator(Node* const* root,
+                                                                      const Node* base,
+                                                                      const string& prefix)
+    : _root(root), _word(prefix) {
+    _stack.push_back({base, 0});
+
+    // O próprio nó base pode ser o fim de um prefixo
+    if (base == nullptr || base->length() == 0) {
+        advance();
     }
 }
 
 /**
- * Insere o prefixo. Cada caractere corresponde a um nó.
- *      Parâmetros:
- *          prefix: Prefíxo (string) a ser inserido.
- *          position: Posição (unsigned long) do caractere no arquivo.
- *          length: Comprimento (unsigned long) da linha do prefixo.
+ * Desce até o próximo nó que é o fim de um prefixo, em ordem alfabética. Quando a subárvore
+ * acaba a pilha fica vazia e o iterador se torna igual ao final.
  **/
-void structures::PrefixTree::insert(const string& prefix, unsigned long position,
-                                    unsigned long length) {
-    if (_root[prefix[0] - ASCII_OFFSET] == nullptr) {  // Checa se o filho na raiz é nulo
-        _root[prefix[0] - ASCII_OFFSET] = new Node(position, length);  // Cria o novo nó
-        if (_root[prefix[0] - ASCII_OFFSET] != nullptr) {  // Verifica se a alocação deu certo
-            if (prefix.length() > 1) {  // Caso o prefixo tenha mais de um caractere
-                // Zera os atributos
-                _root[prefix[0] - ASCII_OFFSET]->position(0);
-                _root[prefix[0] - ASCII_OFFSET]->length(0);
-                // Inserção recursiva
-                _root[prefix[0] - ASCII_OFFSET]->insert(prefix, position, length, 1);
-            } else {
-                // Incrementa a contagem de prefixos contidos
-                _root[prefix[0] - ASCII_OFFSET]->increase_prefix_count();
+template <typename Alphabet>
+inline void structures::PrefixTree<Alphabet>::CompletionIterator::advance() {
+    while (!_stack.empty()) {
+        Frame& top = _stack.back();
+        const Node* child = nullptr;
+        unsigned char key;
+
+        if (top.node != nullptr) {
+            child = top.node->next_child(top.slot, key);
+        } else {  // A raiz da árvore não é um nó, os filhos ficam no vetor _root
+            while (child == nullptr && top.slot < Alphabet::SIZE) {
+                key = top.slot++;
+                child = _root[key];
             }
-        } else {
-            throw std::out_of_range("Allocation Error");
         }
-    } else {
-        // Inserção recursiva
-        _root[prefix[0] - ASCII_OFFSET]->insert(prefix, position, length, 1);
-    }
 
-    ++_size;  // Incrementa o tamanho
-}
-
-/**
- * Remove o prefixo.
- *      Parâmetros:
- *          prefix: Prefíxo (string) a ser removido.
- **/
-void structures::PrefixTree::remove(const string& prefix) {
-    if (_root[prefix[0] - ASCII_OFFSET] != nullptr) {  // Checa se o filho na raiz é nulo
-        if (contains(prefix)) {                        // Checa se o prefixo está na árvore
-            // Remove o prefixo
-            bool deleted_node = _root[prefix[0] - ASCII_OFFSET]->remove(prefix, 1);
-            // Caso o nó filho tenha sido deletado o ponteiro apontará para nulo
-            if (deleted_node) {
-                _root[prefix[0] - ASCII_OFFSET] = nullptr;
+        if (child == nullptr) {  // Todos os filhos já foram visitados
+            _stack.pop_back();
+            if (!_stack.empty()) {  // Apenas os nós acima do nó base adicionam uma letra
+                _word.pop_back();
             }
-        } else {
-            throw std::out_of_range("Prefix not found");
+            continue;
         }
-    } else {
-        throw std::out_of_range("Prefix not found");
-    }
-}
 
-/**
- * Verifica se o prefixo está contido.
- *      Parâmetros:
- *          prefix: Prefíxo (string) a ser verificado.
- *      Retorno (bool): valor que indica se o fim do prefixo foi encontrado ou não.
- **/
-bool structures::PrefixTree::contains(const string& prefix) const {
-    if (_root[prefix[0] - ASCII_OFFSET] != nullptr) {  // Checa se o filho da raiz não é nulo
-        // Verificação recursiva
-        return _root[prefix[0] - ASCII_OFFSET]->contains(prefix, 1);
-    } else {
-        // Caso o filho da raiz seja nulo o prefixo não está contido
-        return false;
+        _word.push_back(Alphabet::symbol(key));
+        _stack.push_back({child, 0});
+
+        if (child->length() != 0) {  // O filho é o fim de um prefixo
+            return;
+        }
     }
 }
 
 /**
- * Retorna verdadeiro caso a árvore esteja vazia.
+ * Avança para o próximo prefixo.
+ *      Retorno (CompletionIterator&): O próprio iterador.
  **/
-bool structures::PrefixTree::empty() const { return size() == 0; }
+template <typename Alphabet>
+inline typename structures::PrefixTree<Alphabet>::CompletionIterator&
+structures::PrefixTree<Alphabet>::CompletionIterator::operator++() {
+    advance();
+    return *this;
+}
 
 /**
- * Retorna o tamanho (std::size_t).
+ * Avança para o próximo prefixo.
+ *      Retorno (CompletionIterator): Cópia do iterador antes de avançar.
  **/
-std::size_t structures::PrefixTree::size() const { return _size; }
+template <typename Alphabet>
+inline typename structures::PrefixTree<Alphabet>::CompletionIterator
+structures::PrefixTree<Alphabet>::CompletionIterator::operator++(int) {
+    CompletionIterator copy(*this);
+    advance();
+    return copy;
+}
 
 /**
- * Retorna uma lista (ArrayList<string>) com todos os prefixos em ordem alfabética.
+ * Compara dois iteradores. Iteradores são iguais quando ambos terminaram ou quando estão no
+ * mesmo nó.
+ *      Parâmetros:
+ *          other: Iterador (const CompletionIterator&) comparado.
+ *      Retorno (bool): Verdadeiro caso os iteradores sejam iguais.
  **/
-structures::ArrayList<string> structures::PrefixTree::aphabetical_order() const {
-    structures::ArrayList<string> list(size());  // Cria a lista
-
-    if (!empty()) {                     // Caso a árvore não esteja vazia
-        string prefix;                  // String para o prefixo
-        for (int i = 0; i < 26; ++i) {  // Itera pelos filhos da raiz
-            if (_root[i] != nullptr) {  // Caso o filho não seja nulo
-                // Ordem alfabética recursiva
-                _root[i]->alphabetical_order(prefix, list, i);
-            }
-        }
+template <typename Alphabet>
+inline bool structures::PrefixTree<Alphabet>::CompletionIterator::operator==(
+    const CompletionIterator& other) const {
+    if (_stack.empty() || other._stack.empty()) {
+        return _stack.empty() && other._stack.empty();
     }
 
-    return list;  // Retorna a lista
+    return _stack.back().node == other._stack.back().node;
 }
 
 /**
- * Retorna o número de prefixos contidos em um prefixo.
+ * Procura o espaço do filho de uma letra.
  *      Parâmetros:
- *          prefix: Prefíxo (string) que está sendo procurado.
- *      Retorno (unsigned long): Número de prefixos contidos em um prefixo.
+ *          key: Índice (unsigned char) da letra.
+ *      Retorno (Node**): Espaço que guarda o filho (nullptr caso não exista).
  **/
-unsigned long structures::PrefixTree::prefix_search(const string& prefix) const {
-    if (_root[prefix[0] - ASCII_OFFSET] != nullptr) {  // Caso o filho do nó não seja nulo
-        // Pesquisa recursiva
-        return _root[prefix[0] - ASCII_OFFSET]->prefix_search(prefix, 1);
+template <typename Alphabet>
+inline typename structures::PrefixTree<Alphabet>::Node**
+structures::PrefixTree<Alphabet>::Node::find_child(unsigned char key) {
+    switch (_type) {
+        case NODE4: {
+            Node4* node = static_cast<Node4*>(this);
+            for (std::size_t i = 0; i < _child_count; ++i) {
+                if (node->_keys[i] == key) {
+                    return &node->_children[i];
+                }
+            }
+            return nullptr;
+        }
+        case NODE16: {
+            Node16* node = static_cast<Node16*>(this);
+#if defined(__SSE2__)
+            // Compara a chave com as 16 chaves de uma vez e descarta as posições sem filho
+            __m128i keys = _mm_loadu_si128(reinterpret_cast<const __m128i*>(node->_keys));
+            __m128i equal = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(key)), keys);
+            int mask = _mm_movemask_epi8(equal) & ((1 << _child_count) - 1);
+            if (mask != 0) {
+                return &node->_children[__builtin_ctz(mask)];
+            }
+#else
+            for (std::size_t i = 0; i < _child_count; ++i) {
+                if (node->_keys[i] == key) {
+                    return &node->_children[i];
+                }
+            }
+#endif
+            return nullptr;
+        }
+        case NODE48: {
+            Node48* node = static_cast<Node48*>(this);
+            return node->_index[key] != 0 ? &node->_children[node->_index[key] - 1] : nullptr;
+        }
+        default: {
+            NodeFull* node = static_cast<NodeFull*>(this);
+            return node->_children[key] != nullptr ? &node->_children[key] : nullptr;
+        }
+    }
+}
+
+/**
+ * Chama a função para cada filho em ordem alfabética.
+ *      Parâmetros:
+ *          function: Função que recebe o índice da letra e o filho.
+ **/
+template <typename Alphabet>
+template <typename Function>
+void structures::PrefixTree<Alphabet>::Node::for_each_child(Function function) const {
+    switch (_type) {
+        case NODE4: {
+            const Node4* node = static_cast<const Node4*>(this);
+            for (std::size_t i = 0; i < _child_count; ++i) {
+                function(node->_keys[i], node->_children[i]);
+            }
+            break;
+        }
+        case NODE16: {
+            const Node16* node = static_cast<const Node16*>(this);
+            for (std::size_t i = 0; i < _child_count; ++i) {
+                function(node->_keys[i], node->_children[i]);
+            }
+            break;
+        }
+        case NODE48: {
+            const Node48* node = static_cast<const Node48*>(this);
+            for (std::size_t i = 0; i < Alphabet::SIZE; ++i) {
+                if (node->_index[i] != 0) {
+                    function(static_cast<unsigned char>(i), node->_children[node->_index[i] - 1]);
+                }
+            }
+            break;
+        }
+        default: {
+            const NodeFull* node = static_cast<const NodeFull*>(this);
+            for (std::size_t i = 0; i < Alphabet::SIZE; ++i) {
+                if (node->_children[i] != nullptr) {
+                    function(static_cast<unsigned char>(i), node->_children[i]);
+                }
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * Retorna o próximo filho em ordem alfabética a partir de uma posição e avança a posição para
+ * depois dele. Nos nós de chaves ordenadas a posição é o índice da chave e nos demais é a letra.
+ *      Parâmetros:
+ *          slot: Posição (std::size_t&) da busca, começando em 0.
+ *          key: Índice (unsigned char&) da letra do filho encontrado.
+ *      Retorno (const Node*): Filho encontrado (nullptr caso não existam mais filhos).
+ **/
+template <typename Alphabet>
+inline const typename structures::PrefixTree<Alphabet>::Node*
+structures::PrefixTree<Alphabet>::Node::next_child(std::size_t& slot, unsigned char& key) const {
+    switch (_type) {
+        case NODE4: {
+            const Node4* node = static_cast<const Node4*>(this);
+            if (slot < _child_count) {
+                key = node->_keys[slot];
+                return node->_children[slot++];
+            }
+            return nullptr;
+        }
+        case NODE16: {
+            const Node16* node = static_cast<const Node16*>(this);
+            if (slot < _child_count) {
+                key = node->_keys[slot];
+                return node->_children[slot++];
+            }
+            return nullptr;
+        }
+        case NODE48: {
+            const Node48* node = static_cast<const Node48*>(this);
+            while (slot < Alphabet::SIZE) {
+                key = static_cast<unsigned char>(slot++);
+                if (node->_index[key] != 0) {
+                    return node->_children[node->_index[key] - 1];
+                }
+            }
+            return nullptr;
+        }
+        default: {
+            const NodeFull* node = static_cast<const NodeFull*>(this);
+            while (slot < Alphabet::SIZE) {
+                key = static_cast<unsigned char>(slot++);
+                if (node->_children[key] != nullptr) {
+                    return node->_children[key];
+                }
+            }
+            return nullptr;
+        }
+    }
+}
+
+/**
+ * Recalcula o maior peso a partir do peso do nó e do maior peso de cada filho. O peso do nó só
+ * conta quando ele é o fim de um prefixo.
+ **/
+template <typename Alphabet>
+inline void structures::PrefixTree<Alphabet>::Node::update_max_weight() {
+    _max_weight = _length != 0 ? _weight : 0;
+
+    for_each_child([&](unsigned char, const Node* child) {
+        if (child->_max_weight > _max_weight) {
+            _max_weight = child->_max_weight;
+        }
+    });
+}
+
+/**
+ * Adiciona um filho. Caso o nó esteja cheio ele é trocado por um nó maior e o ponteiro que o
+ * referencia é atualizado. Nos alfabetos de até 48 letras o Node16 cresce direto para o NodeFull.
+ *      Parâmetros:
+ *          ref: Ponteiro (Node*&) que referencia o nó.
+ *          key: Índice (unsigned char) da letra do filho.
+ *          child: Filho (Node*) a ser adicionado.
+ *          pool: Conjunto de arenas (NodePool) de onde os nós são alocados.
+ *      Retorno (Node**): Espaço que guarda o filho adicionado.
+ **/
+template <typename Alphabet>
+inline typename structures::PrefixTree<Alphabet>::Node**
+structures::PrefixTree<Alphabet>::Node::add_child(Node*& ref, unsigned char key, Node* child,
+                                                  NodePool& pool) {
+    Node* node = ref;
+
+    // Nós cheios crescem para o próximo tipo antes da inserção
+    if ((node->_type == NODE4 && node->_child_count == 4) ||
+        (node->_type == NODE16 && node->_child_count == 16) ||
+        (node->_type == NODE48 && node->_child_count == 48)) {
+        NodeType type = NODEFULL;
+        if (node->_type == NODE4) {
+            type = NODE16;
+        } else if (node->_type == NODE16 && Alphabet::SIZE > 48) {
+            type = NODE48;
+        }
+
+        Node* grown = pool.allocate(type);
+        grown->_position = node->_position;
+        grown->_length = node->_length;
+        grown->_prefix_count = node->_prefix_count;
+        grown->_weight = node->_weight;
+        grown->_max_weight = node->_max_weight;
+
+        // Copia os filhos para o novo nó, que os mantém em ordem
+        node->for_each_child([&](unsigned char k, const Node* c) {
+            add_child(grown, k, const_cast<Node*>(c), pool);
+        });
+
+        pool.deallocate(node);
+        ref = grown;
+        node = grown;
+    }
+
+    switch (node->_type) {
+        case NODE4:
+        case NODE16: {
+            unsigned char* keys;
+            Node** children;
+            if (node->_type == NODE4) {
+                keys = static_cast<Node4*>(node)->_keys;
+                children = static_cast<Node4*>(node)->_children;
+            } else {
+                keys = static_cast<Node16*>(node)->_keys;
+                children = static_cast<Node16*>(node)->_children;
+            }
+
+            // Empurra as chaves maiores para manter a ordem alfabética
+            std::size_t i = node->_child_count;
+            while (i > 0 && keys[i - 1] > key) {
+                keys[i] = keys[i - 1];
+                children[i] = children[i - 1];
+                --i;
+            }
+
+            keys[i] = key;
+            children[i] = child;
+            ++node->_child_count;
+            return &children[i];
+        }
+        case NODE48: {
+            // Usa a primeira posição livre, a ordem alfabética fica no índice das letras
+            Node48* node48 = static_cast<Node48*>(node);
+            std::size_t i = 0;
+            while (node48->_children[i] != nullptr) {
+                ++i;
+            }
+
+            node48->_children[i] = child;
+            node48->_index[key] = static_cast<unsigned char>(i + 1);
+            ++node->_child_count;
+            return &node48->_children[i];
+        }
+        default: {
+            NodeFull* full = static_cast<NodeFull*>(node);
+            full->_children[key] = child;
+            ++node->_child_count;
+            return &full->_children[key];
+        }
+    }
+}
+
+/**
+ * Remove um filho. Caso o nó fique com poucos filhos ele é trocado por um nó menor e o
+ * ponteiro que o referencia é atualizado.
+ *      Parâmetros:
+ *          ref: Ponteiro (Node*&) que referencia o nó.
+ *          key: Índice (unsigned char) da letra do filho.
+ *          pool: Conjunto de arenas (NodePool) que recebe os nós trocados.
+ **/
+template <typename Alphabet>
+inline void structures::PrefixTree<Alphabet>::Node::remove_child(Node*& ref, unsigned char key,
+                                                                 NodePool& pool) {
+    Node* node = ref;
+
+    switch (node->_type) {
+        case NODE4:
+        case NODE16: {
+            unsigned char* keys;
+            Node** children;
+            if (node->_type == NODE4) {
+                keys = static_cast<Node4*>(node)->_keys;
+                children = static_cast<Node4*>(node)->_children;
+            } else {
+                keys = static_cast<Node16*>(node)->_keys;
+                children = static_cast<Node16*>(node)->_children;
+            }
+
+            // Puxa as chaves seguintes para o lugar do filho removido
+            std::size_t i = 0;
+            while (keys[i] != key) {
+                ++i;
+            }
+            for (; i + 1 < node->_child_count; ++i) {
+                keys[i] = keys[i + 1];
+                children[i] = children[i + 1];
+            }
+
+            --node->_child_count;
+            break;
+        }
+        case NODE48: {
+            Node48* node48 = static_cast<Node48*>(node);
+            node48->_children[node48->_index[key] - 1] = nullptr;
+            node48->_index[key] = 0;
+            --node->_child_count;
+            break;
+        }
+        default:
+            static_cast<NodeFull*>(node)->_children[key] = nullptr;
+            --node->_child_count;
+            break;
+    }
+
+    // Os nós encolhem com uma folga em relação ao limite de crescimento, assim inserções e
+    // remoções alternadas não trocam o nó a cada operação
+    NodeType type = node->_type;
+    if (node->_type == NODE16 && node->_child_count <= 3) {
+        type = NODE4;
+    } else if (node->_type == NODE48 && node->_child_count <= 12) {
+        type = NODE16;
+    } else if (node->_type == NODEFULL) {
+        if (Alphabet::SIZE > 48 && node->_child_count <= 40) {
+            type = NODE48;
+        } else if (Alphabet::SIZE <= 48 && node->_child_count <= 12) {
+            type = NODE16;
+        }
+    }
+
+    if (type != node->_type) {
+        Node* shrunk = pool.allocate(type);
+        shrunk->_position = node->_position;
+        shrunk->_length = node->_length;
+        shrunk->_prefix_count = node->_prefix_count;
+        shrunk->_weight = node->_weight;
+        shrunk->_max_weight = node->_max_weight;
+
+        node->for_each_child([&](unsigned char k, const Node* c) {
+            add_child(shrunk, k, const_cast<Node*>(c), pool);
+        });
+
+        pool.deallocate(node);
+        ref = shrunk;
+    }
+}
+
+/**
+ * Remove o prefixo de forma recursiva. Cada letra corresponde a um nó e os nós que ficarem sem
+ * prefixos são devolvidos para a arena. Esse método só funciona se o prefixo existir e não pode
+ * ser chamado antes da verificação da presença do nó.
+ *      Parâmetros:
+ *          ref: Ponteiro (Node*&) que referencia o nó (nulo caso o nó seja deletado).
+ *          keys: Índices (string) das letras do prefixo a ser removido.
+ *          index: Posição (std::size_t) da próxima letra do prefixo.
+ *          pool: Conjunto de arenas (NodePool) que recebe os nós deletados.
+ **/
+template <typename Alphabet>
+inline void structures::PrefixTree<Alphabet>::Node::remove(Node*& ref, const string& keys,
+                                                           const std::size_t& index,
+                                                           NodePool& pool) {
+    Node* node = ref;
+    bool child_deleted = false;  // Condição de deleção do filho
+    unsigned char key = 0;       // Índice da letra do filho
+
+    if (index < keys.length()) {  // O nó alvo está abaixo deste nó
+        key = static_cast<unsigned char>(keys[index]);
+        Node** slot = node->find_child(key);
+        remove(*slot, keys, index + 1, pool);
+        child_deleted = *slot == nullptr;
+    } else {  // Este nó é o alvo, então os seus dados são apagados
+        node->position(0);
+        node->length(0);
+        node->weight(0);
+    }
+
+    node->decrease_prefix_count();  // Decrementa a contagem de prefixos incluídos
+
+    // Um nó sem prefixos abaixo dele também não tem filhos, então ele é deletado
+    if (node->prefix_count() == 0) {
+        pool.deallocate(node);
+        ref = nullptr;
+        return;
+    }
+
+    if (child_deleted) {
+        remove_child(ref, key, pool);
+    }
+
+    // O prefixo removido pode ter sido o de maior peso abaixo do nó
+    ref->update_max_weight();
+}
+
+/**
+ * Constrói um objeto structures::PrefixTree.
+ **/
+template <typename Alphabet>
+structures::PrefixTree<Alphabet>::PrefixTree() : PrefixTree(DEFAULT_CHUNK_SIZE) {}
+
+/**
+ * Constrói um objeto structures::PrefixTree.
+ *      Parâmetros:
+ *          chunk_size: Quantidade (std::size_t) de nós em cada bloco da arena. Com 0 a árvore
+ *              não usa a arena: cada nó é alocado com new e liberado com delete, um a um.
+ **/
+template <typename Alphabet>
+structures::PrefixTree<Alphabet>::PrefixTree(std::size_t chunk_size) : _pool(chunk_size) {
+    // Inicializa os atributos
+    for (std::size_t i = 0; i < Alphabet::SIZE; ++i) {
+        _root[i] = nullptr;
+    }
+
+    _size = 0u;
+}
+
+/**
+ * Destrói o objeto structures::PrefixTree.
+ **/
+template <typename Alphabet>
+structures::PrefixTree<Alphabet>::~PrefixTree() {
+    // Sem a arena cada nó é liberado em uma busca em profundidade com pilha explícita
+    if (!_pool.pooled()) {
+        std::vector<Node*> stack;
+        for (std::size_t i = 0; i < Alphabet::SIZE; ++i) {
+            if (_root[i] != nullptr) {
+                stack.push_back(_root[i]);
+            }
+        }
+
+        while (!stack.empty()) {
+            Node* node = stack.back();
+            stack.pop_back();
+            node->for_each_child([&](unsigned char, const Node* child) {
+                stack.push_back(const_cast<Node*>(child));
+            });
+            _pool.deallocate(node);
+        }
+    }
+
+    // Com a arena todos os nós estão nos blocos, então a árvore inteira é liberada de uma só vez
+    _pool.clear();
+}
+
+/**
+ * Insere o prefixo. Cada letra do alfabeto corresponde a um nó.
+ *      Parâmetros:
+ *          prefix: Prefíxo (std::string_view) a ser inserido. Os caracteres são copiados para
+ *              os nós, então o texto não precisa existir depois da inserção.
+ *          position: Posição (unsigned long) do caractere no arquivo.
+ *          length: Comprimento (unsigned long) da linha do prefixo.
+ *          weight: Peso (unsigned int) do prefixo, usado na ordenação de top_k.
+ **/
+template <typename Alphabet>
+void structures::PrefixTree<Alphabet>::insert(std::string_view prefix, unsigned long position,
+                                              unsigned long length, unsigned int weight) {
+    PREFIX_TREE_MEASURE(_operations.insert);
+    string keys;  // Índices das letras do prefixo
+
+    // As letras são validadas antes de qualquer nó ser criado
+    if (!to_keys(prefix, keys)) {
+        throw std::out_of_range("Invalid character");
+    }
+    if (keys.empty()) {
+        throw std::out_of_range("Empty prefix");
+    }
+
+    // Desce pelo caminho do prefixo criando os nós que faltam. Cada nó do caminho passa a
+    // conter mais um prefixo e o peso do prefixo entra no maior peso de cada um
+    Node** slot = &_root[static_cast<unsigned char>(keys[0])];
+    if (*slot == nullptr) {
+        *slot = _pool.allocate(NODE4);
+    }
+
+    for (std::size_t i = 1; i < keys.length(); ++i) {
+        (*slot)->increase_prefix_count();
+        if (weight > (*slot)->_max_weight) {
+            (*slot)->_max_weight = weight;
+        }
+
+        unsigned char key = static_cast<unsigned char>(keys[i]);
+        Node** child = (*slot)->find_child(key);
+        if (child == nullptr) {  // O caractere ainda não tem um nó
+            child = Node::add_child(*slot, key, _pool.allocate(NODE4), _pool);
+        }
+
+        slot = child;
+    }
+
+    // O último nó guarda os dados do prefixo
+    Node* node = *slot;
+    unsigned int previous = node->length() != 0 ? node->weight() : 0;
+    node->increase_prefix_count();
+    node->position(position);
+    node->length(length);
+    node->weight(weight);
+
+    if (weight >= previous) {
+        if (weight > node->_max_weight) {
+            node->_max_weight = weight;
+        }
     } else {
-        return 0;  // Nenhum prefixo encontrado
+        // O prefixo já existia com um peso maior, então os maiores pesos do caminho são
+        // recalculados de baixo para cima
+        std::vector<Node*> path;
+        Node* current = _root[static_cast<unsigned char>(keys[0])];
+        path.push_back(current);
+        for (std::size_t i = 1; i < keys.length(); ++i) {
+            current = *current->find_child(static_cast<unsigned char>(keys[i]));
+            path.push_back(current);
+        }
+
+        for (std::size_t i = path.size(); i > 0; --i) {
+            path[i - 1]->update_max_weight();
+        }
+    }
+
+    ++_size;  // Incrementa o tamanho
+}
+
+/**
+ * Insere prefixos que estão em ordem alfabética em tempo linear. Apenas o caminho mais à direita
+ * da árvore é mantido: cada prefixo é anexado a ele a partir do ponto em que se separa do
+ * prefixo anterior, e a contagem de prefixos de um nó só é somada ao pai quando o nó sai do
+ * caminho. Caso a árvore não esteja vazia, ou caso um prefixo esteja fora de ordem, os prefixos
+ * restantes são inseridos normalmente.
+ *      Parâmetros:
+ *          begin: Iterador (de avanço) para o primeiro Entry (ou EntryView).
+ *          end: Iterador para o fim dos Entry.
+ **/
+template <typename Alphabet>
+template <typename Iterator>
+void structures::PrefixTree<Alphabet>::build_sorted(Iterator begin, Iterator end) {
+    if (!empty()) {  // A construção em bloco só é possível em uma árvore vazia
+        for (; begin != end; ++begin) {
+            insert(begin->prefix, begin->position, begin->length, begin->weight);
+        }
+        return;
+    }
+
+    std::vector<Node**> path;  // Espaços dos nós do caminho mais à direita
+    string keys;               // Índices das letras do prefixo atual
+    string previous;           // Índices das letras do prefixo anterior
+    bool first = true;         // Verdadeiro até o primeiro prefixo ser anexado
+
+    // Tira os nós mais profundos do caminho, somando a contagem de cada um na do pai e levando o
+    // maior peso para o pai
+    auto close = [&](std::size_t depth) {
+        while (path.size() > depth) {
+            Node* node = *path.back();
+            path.pop_back();
+
+            if (!path.empty()) {
+                Node* parent = *path.back();
+                parent->_prefix_count += node->_prefix_count;
+                if (node->_max_weight > parent->_max_weight) {
+                    parent->_max_weight = node->_max_weight;
+                }
+            }
+        }
+    };
+
+    for (; begin != end; ++begin) {
+        // A ordem considerada é a dos índices das letras, que é a do alfabeto
+        if (!to_keys(begin->prefix, keys)) {
+            close(0);
+            throw std::out_of_range("Invalid character");
+        }
+        if (keys.empty()) {
+            close(0);
+            throw std::out_of_range("Empty prefix");
+        }
+
+        if (!first && keys < previous) {  // A entrada não está ordenada
+            break;
+        }
+
+        // Mede o trecho em comum com o prefixo anterior, que é o que continua no caminho
+        std::size_t common = 0;
+        if (!first) {
+            while (common < keys.length() && common < previous.length() &&
+                   keys[common] == previous[common]) {
+                ++common;
+            }
+        }
+
+        close(common);
+
+        // Anexa o resto do prefixo ao caminho
+        for (std::size_t i = common; i < keys.length(); ++i) {
+            unsigned char key = static_cast<unsigned char>(keys[i]);
+
+            if (i == 0) {
+                _root[key] = _pool.allocate(NODE4);
+                path.push_back(&_root[key]);
+            } else {
+                path.push_back(Node::add_child(*path.back(), key, _pool.allocate(NODE4), _pool));
+            }
+        }
+
+        // O último nó guarda os dados do prefixo. Os filhos dele ainda não saíram do caminho,
+        // então o maior peso do nó é o próprio peso
+        Node* node = *path.back();
+        node->increase_prefix_count();
+        node->position(begin->position);
+        node->length(begin->length);
+        node->weight(begin->weight);
+        node->_max_weight = begin->weight;
+
+        ++_size;
+        previous.swap(keys);
+        first = false;
+    }
+
+    close(0);
+
+    // Os prefixos fora de ordem são inseridos normalmente
+    for (; begin != end; ++begin) {
+        insert(begin->prefix, begin->position, begin->length, begin->weight);
+    }
+}
+
+/**
+ * Insere prefixos construindo as subárvores da raiz em paralelo. Os prefixos são separados pela
+ * primeira letra, mantendo a ordem da entrada, e letras com mais prefixos do que a parte justa
+ * de cada thread são separadas também pela segunda letra. Cada parte é construída por uma
+ * thread em uma árvore própria (com build_sorted) e no fim as subárvores e as arenas são
+ * transferidas para esta árvore. Caso a árvore não esteja vazia os prefixos são inseridos
+ * normalmente.
+ *      Parâmetros:
+ *          begin: Iterador (de avanço) para o primeiro Entry (ou EntryView).
+ *          end: Iterador para o fim dos Entry.
+ *          threads: Quantidade (unsigned) de threads.
+ **/
+template <typename Alphabet>
+template <typename Iterator>
+void structures::PrefixTree<Alphabet>::build_parallel(Iterator begin, Iterator end,
+                                                      unsigned threads) {
+    if (!empty() || threads <= 1) {
+        build_sorted(begin, end);
+        return;
+    }
+
+    // Separa os prefixos pela primeira letra
+    std::vector<Iterator> buckets[Alphabet::SIZE];
+    std::size_t total = 0;
+    for (Iterator it = begin; it != end; ++it) {
+        KeyReader reader(it->prefix);
+        int key;
+
+        if (!reader.next(key)) {
+            throw std::out_of_range("Empty prefix");
+        }
+        if (key == AlphabetIndex::INVALID) {
+            throw std::out_of_range("Invalid character");
+        }
+
+        buckets[key].push_back(it);
+        ++total;
+    }
+
+    // Parte construída por uma thread. A segunda letra é Alphabet::SIZE quando a letra não foi
+    // separada
+    struct Task {
+        std::size_t first;                 // Primeira letra
+        std::size_t second;                // Segunda letra
+        std::vector<Iterator> items;       // Prefixos da parte, na ordem da entrada
+        std::unique_ptr<PrefixTree> tree;  // Árvore construída
+    };
+
+    std::vector<Task> tasks;
+    std::vector<Iterator> single[Alphabet::SIZE];  // Prefixos de uma letra das letras separadas
+    std::size_t limit = total / threads + 1;
+
+    for (std::size_t i = 0; i < Alphabet::SIZE; ++i) {
+        if (buckets[i].empty()) {
+            continue;
+        }
+
+        if (buckets[i].size() <= limit) {
+            tasks.push_back({i, Alphabet::SIZE, std::move(buckets[i]), nullptr});
+            continue;
+        }
+
+        // Letra com muitos prefixos, separada pela segunda letra
+        std::vector<Iterator> parts[Alphabet::SIZE];
+        for (const Iterator& it : buckets[i]) {
+            KeyReader reader(it->prefix);
+            int key;
+            reader.next(key);  // Primeira letra
+
+            if (!reader.next(key)) {
+                single[i].push_back(it);
+            } else if (key == AlphabetIndex::INVALID) {
+                throw std::out_of_range("Invalid character");
+            } else {
+                parts[key].push_back(it);
+            }
+        }
+
+        for (std::size_t j = 0; j < Alphabet::SIZE; ++j) {
+            if (!parts[j].empty()) {
+                tasks.push_back({i, j, std::move(parts[j]), nullptr});
+            }
+        }
+    }
+
+    // As threads pegam as partes em ordem, começando pelas maiores
+    std::vector<std::size_t> order(tasks.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return tasks[a].items.size() > tasks[b].items.size();
+    });
+
+    std::atomic<std::size_t> next(0);
+    std::exception_ptr error = nullptr;
+    std::atomic<bool> failed(false);
+    std::size_t chunk_size = _pool.chunk_size();
+
+    auto worker = [&]() {
+        for (std::size_t k = next++; k < order.size(); k = next++) {
+            Task& task = tasks[order[k]];
+            try {
+                task.tree.reset(new PrefixTree(chunk_size));
+                IndirectIterator<Iterator> first = {task.items.cbegin()};
+                IndirectIterator<Iterator> last = {task.items.cend()};
+                task.tree->build_sorted(first, last);
+            } catch (...) {
+                if (!failed.exchange(true)) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    std::size_t count = threads < tasks.size() ? threads : tasks.size();
+    for (std::size_t i = 1; i < count; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();  // A thread atual também constrói partes
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+
+    if (error != nullptr) {
+        std::rethrow_exception(error);
+    }
+
+    // Transfere as subárvores. As partes estão em ordem de primeira e segunda letra
+    for (Task& task : tasks) {
+        PrefixTree& tree = *task.tree;
+        std::size_t i = task.first;
+        unsigned char second = static_cast<unsigned char>(task.second);
+
+        _pool.splice(tree._pool);  // Os nós da parte passam a ser desta árvore
+
+        if (task.second == Alphabet::SIZE) {  // A parte é a subárvore inteira da letra
+            _root[i] = tree._root[i];
+        } else {
+            if (_root[i] == nullptr) {  // Primeira parte da letra, cria o nó da raiz
+                _root[i] = _pool.allocate(NODE4);
+            }
+
+            // O filho da segunda letra passa para o nó da raiz desta árvore e o nó da raiz da
+            // parte é descartado
+            Node* child = *tree._root[i]->find_child(second);
+            Node::add_child(_root[i], second, child, _pool);
+            _root[i]->_prefix_count += child->_prefix_count;
+            if (child->_max_weight > _root[i]->_max_weight) {
+                _root[i]->_max_weight = child->_max_weight;
+            }
+            _pool.deallocate(tree._root[i]);
+        }
+
+        tree._root[i] = nullptr;
+        _size += tree._size;
+    }
+
+    // Os prefixos de uma letra das letras separadas são aplicados no nó da raiz
+    for (std::size_t i = 0; i < Alphabet::SIZE; ++i) {
+        for (const Iterator& it : single[i]) {
+            if (_root[i] == nullptr) {
+                _root[i] = _pool.allocate(NODE4);
+            }
+
+            _root[i]->increase_prefix_count();
+            _root[i]->position(it->position);
+            _root[i]->length(it->length);
+            _root[i]->weight(it->weight);
+            _root[i]->update_max_weight();
+            ++_size;
+        }
+    }
+}
+
+/**
+ * Converte o prefixo nos índices das suas letras, pulando os bytes que o alfabeto ignora.
+ *      Parâmetros:
+ *          prefix: Prefíxo (std::string_view) a ser convertido.
+ *          keys: Índices (string&) das letras, um por caractere.
+ *      Retorno (bool): Falso caso algum caractere não pertença ao alfabeto.
+ **/
+template <typename Alphabet>
+bool structures::PrefixTree<Alphabet>::to_keys(std::string_view prefix, string& keys) {
+    KeyReader reader(prefix);
+    int key;
+
+    keys.clear();
+    while (reader.next(key)) {
+        if (key == AlphabetIndex::INVALID) {
+            return false;
+        }
+        keys.push_back(static_cast<char>(key));
+    }
+
+    return true;
+}
+
+/**
+ * Remove o prefixo.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) a ser removido.
+ **/
+template <typename Alphabet>
+void structures::PrefixTree<Alphabet>::remove(const string& prefix) {
+    PREFIX_TREE_MEASURE(_operations.remove);
+
+    if (descend(prefix).found) {  // Checa se o prefixo está na árvore
+        string keys;
+        to_keys(prefix, keys);
+
+        // Remove o prefixo. Caso o nó da raiz seja deletado o ponteiro apontará para nulo
+        Node::remove(_root[static_cast<unsigned char>(keys[0])], keys, 1, _pool);
+        --_size;  // Decrementa o tamanho
+    } else {
+        throw std::out_of_range("Prefix not found");
+    }
+}
+
+/**
+ * Verifica se o prefixo está contido.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) a ser verificado.
+ *      Retorno (bool): valor que indica se o fim do prefixo foi encontrado ou não.
+ **/
+template <typename Alphabet>
+bool structures::PrefixTree<Alphabet>::contains(const string& prefix) const {
+    return lookup(prefix).found;
+}
+
+/**
+ * Retorna verdadeiro caso a árvore esteja vazia.
+ **/
+template <typename Alphabet>
+bool structures::PrefixTree<Alphabet>::empty() const { return size() == 0; }
+
+/**
+ * Retorna o tamanho (std::size_t).
+ **/
+template <typename Alphabet>
+std::size_t structures::PrefixTree<Alphabet>::size() const { return _size; }
+
+/**
+ * Retorna uma lista (ArrayList<string>) com todos os prefixos em ordem alfabética.
+ **/
+template <typename Alphabet>
+structures::ArrayList<string> structures::PrefixTree<Alphabet>::aphabetical_order() const {
+    structures::ArrayList<string> list(size());  // Cria a lista
+
+    for (const string& prefix : complete("")) {
+        list.push_back(prefix);
+    }
+
+    return list;  // Retorna a lista
+}
+
+/**
+ * Retorna os prefixos que começam com o prefixo do parâmetro, em ordem alfabética. Apenas a
+ * descida até o prefixo é feita aqui, os prefixos são gerados conforme o iterador avança e
+ * nada fora da subárvore do prefixo é visitado. Os prefixos são escritos com os caracteres do
+ * alfabeto (sem acento no Utf8Folded).
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) que está sendo completado.
+ *      Retorno (Completion): Intervalo com os prefixos encontrados (vazio caso não existam).
+ **/
+template <typename Alphabet>
+typename structures::PrefixTree<Alphabet>::Completion structures::PrefixTree<Alphabet>::complete(
+    const string& prefix) const {
+    const Node* node = nullptr;  // Nullptr representa a raiz da árvore
+    string word;                 // Prefixo escrito com os caracteres do alfabeto
+    KeyReader reader(prefix);
+    int key;
+
+    while (reader.next(key)) {
+        if (key == AlphabetIndex::INVALID) {  // Caractere fora do alfabeto
+            return Completion(CompletionIterator());
+        }
+
+        node = node == nullptr ? _root[key] : node->child(key);
+
+        if (node == nullptr) {  // O prefixo não existe na árvore
+            return Completion(CompletionIterator());
+        }
+
+        word.push_back(Alphabet::symbol(key));
+    }
+
+    return Completion(CompletionIterator(_root, node, word));
+}
+
+/**
+ * Retorna os k prefixos de maior peso que começam com o prefixo do parâmetro, do maior peso
+ * para o menor. A busca é feita pelo melhor primeiro: a fila de prioridade guarda subárvores,
+ * ordenadas pelo maior peso abaixo delas, e prefixos, ordenados pelo próprio peso. Um prefixo
+ * que sai da fila não pode ser superado por nada que ainda esteja nela, então a busca termina
+ * assim que k prefixos saem e as subárvores que não superam o k-ésimo nunca são abertas.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) que está sendo completado.
+ *          k: Quantidade (std::size_t) máxima de prefixos.
+ *      Retorno (ArrayList<string>): Lista com até k prefixos.
+ **/
+template <typename Alphabet>
+structures::ArrayList<string> structures::PrefixTree<Alphabet>::top_k(const string& prefix,
+                                                            std::size_t k) const {
+    const std::size_t NONE = static_cast<std::size_t>(-1);
+
+    // Nó alcançado pela busca. O prefixo é reconstruído pela cadeia de pais
+    struct Step {
+        const Node* node;    // Nó
+        std::size_t parent;  // Passo do pai (NONE para o nó do prefixo e os filhos da raiz)
+        bool has_letter;     // Falso para o nó do prefixo, cuja letra já está no prefixo
+        char letter;         // Letra do nó
+    };
+
+    // Item da fila. Em caso de empate os prefixos saem antes das subárvores
+    struct Candidate {
+        unsigned int score;  // Peso do prefixo ou maior peso da subárvore
+        bool word;           // Verdadeiro caso seja um prefixo
+        std::size_t step;    // Passo do nó
+
+        bool operator<(const Candidate& other) const {
+            if (score != other.score) {
+                return score < other.score;
+            }
+            if (word != other.word) {
+                return !word;
+            }
+            return step > other.step;
+        }
+    };
+
+    std::vector<Step> steps;
+    std::priority_queue<Candidate> queue;
+
+    // Desce até o nó do prefixo
+    const Node* node = nullptr;  // Nullptr representa a raiz da árvore
+    string word;                 // Prefixo escrito com os caracteres do alfabeto
+    KeyReader reader(prefix);
+    int key;
+    bool exists = true;          // Falso caso o prefixo não exista na árvore
+
+    while (exists && reader.next(key)) {
+        if (key == AlphabetIndex::INVALID) {
+            exists = false;
+        } else {
+            node = node == nullptr ? _root[key] : node->child(key);
+            exists = node != nullptr;
+            word.push_back(Alphabet::symbol(key));
+        }
+    }
+
+    if (exists && node == nullptr) {
+        // A raiz da árvore não é um nó, então um prefixo vazio começa pelos filhos dela
+        for (std::size_t i = 0; i < Alphabet::SIZE; ++i) {
+            if (_root[i] != nullptr) {
+                steps.push_back({_root[i], NONE, true, Alphabet::symbol(i)});
+                queue.push({_root[i]->max_weight(), false, steps.size() - 1});
+            }
+        }
+    } else if (exists) {
+        steps.push_back({node, NONE, false, 0});
+        queue.push({node->max_weight(), false, 0});
+    }
+
+    structures::ArrayList<string> list(k < size() ? k : size());  // A lista cresce se preciso
+    string suffix;  // Letras abaixo do prefixo, da última para a primeira
+
+    while (list.size() < k && !queue.empty()) {
+        Candidate candidate = queue.top();
+        queue.pop();
+
+        if (candidate.word) {  // Nenhum item da fila supera este prefixo
+            suffix.clear();
+            for (std::size_t s = candidate.step; s != NONE; s = steps[s].parent) {
+                if (steps[s].has_letter) {
+                    suffix.push_back(steps[s].letter);
+                }
+            }
+
+            list.push_back(word + string(suffix.rbegin(), suffix.rend()));
+            continue;
+        }
+
+        // Abre a subárvore: o prefixo do nó e cada filho entram na fila
+        const Node* current = steps[candidate.step].node;
+        if (current->length() != 0) {
+            queue.push({current->weight(), true, candidate.step});
+        }
+
+        std::size_t parent = candidate.step;
+        current->for_each_child([&](unsigned char letter, const Node* child) {
+            steps.push_back({child, parent, true, Alphabet::symbol(letter)});
+            queue.push({child->max_weight(), false, steps.size() - 1});
+        });
+    }
+
+    return list;
+}
+
+/**
+ * Retorna os prefixos cuja distância de Levenshtein até a palavra é no máximo max_edits. A
+ * árvore é percorrida em profundidade e cada nó calcula a linha da tabela de distâncias do seu
+ * prefixo a partir da linha do pai, então o trabalho de um prefixo comum é feito uma só vez.
+ * Como os valores de uma linha nunca diminuem nas linhas de baixo, a subárvore é descartada
+ * assim que o menor valor da linha passa do limite. Os caracteres da palavra são convertidos
+ * pelo alfabeto; um caractere fora do alfabeto nunca coincide com uma letra e só pode ser
+ * trocado ou removido.
+ *      Parâmetros:
+ *          word: Palavra (string) pesquisada.
+ *          max_edits: Quantidade (std::size_t) máxima de inserções, remoções e trocas.
+ *      Retorno (ArrayList<FuzzyMatch>): Prefixos encontrados em ordem alfabética.
+ **/
+template <typename Alphabet>
+structures::ArrayList<typename structures::PrefixTree<Alphabet>::FuzzyMatch>
+structures::PrefixTree<Alphabet>::fuzzy_search(const string& word, std::size_t max_edits) const {
+    // Letras da palavra (AlphabetIndex::INVALID para os caracteres fora do alfabeto)
+    std::vector<int> letters;
+    KeyReader reader(word);
+    int key;
+    while (reader.next(key)) {
+        letters.push_back(key);
+    }
+
+    // Linhas da tabela, uma por profundidade: a linha d guarda a distância entre o prefixo de d
+    // letras atual e cada começo da palavra
+    const std::size_t width = letters.size() + 1;
+    std::vector<std::size_t> rows(width);
+    for (std::size_t j = 0; j < width; ++j) {
+        rows[j] = j;
+    }
+
+    // Percurso em profundidade com pilha explícita. Um quadro com nó nulo representa a raiz
+    struct Frame {
+        const Node* node;  // Nó cujos filhos estão sendo visitados
+        std::size_t slot;  // Posição do próximo filho
+    };
+    std::vector<Frame> stack;
+    stack.push_back({nullptr, 0});
+
+    ArrayList<FuzzyMatch> matches;
+    string prefix;  // Prefixo do nó do topo da pilha
+
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        const Node* child = nullptr;
+        unsigned char letter = 0;
+
+        if (frame.node == nullptr) {
+            while (child == nullptr && frame.slot < Alphabet::SIZE) {
+                letter = static_cast<unsigned char>(frame.slot);
+                child = _root[frame.slot++];
+            }
+        } else {
+            child = frame.node->next_child(frame.slot, letter);
+        }
+
+        if (child == nullptr) {  // Todos os filhos foram visitados
+            if (frame.node != nullptr) {
+                prefix.pop_back();
+            }
+            stack.pop_back();
+            continue;
+        }
+
+        // Linha do filho a partir da linha do nó
+        const std::size_t depth = stack.size();
+        if (rows.size() < (depth + 1) * width) {
+            rows.resize((depth + 1) * width);
+        }
+        const std::size_t* above = &rows[(depth - 1) * width];
+        std::size_t* row = &rows[depth * width];
+
+        row[0] = above[0] + 1;
+        std::size_t minimum = row[0];
+        for (std::size_t j = 1; j < width; ++j) {
+            std::size_t cost = letters[j - 1] == letter ? 0 : 1;
+            std::size_t best = above[j - 1] + cost;  // Troca (ou letra igual)
+            best = std::min(best, above[j] + 1);     // Letra a mais no prefixo
+            best = std::min(best, row[j - 1] + 1);   // Letra a menos no prefixo
+            row[j] = best;
+            minimum = std::min(minimum, best);
+        }
+
+        if (minimum > max_edits) {  // Nenhum prefixo da subárvore fica dentro do limite
+            continue;
+        }
+
+        prefix.push_back(Alphabet::symbol(letter));
+        if (child->length() != 0 && row[width - 1] <= max_edits) {
+            matches.push_back({prefix, child->position(), child->length(), row[width - 1]});
+        }
+        stack.push_back({child, 0});
+    }
+
+    return matches;
+}
+
+/**
+ * Compila o padrão. '?' aceita uma letra, '*' aceita qualquer sequência de letras (inclusive
+ * vazia) e '[...]' aceita uma letra do conjunto, com intervalos como "a-f" e negação com '^' ou
+ * '!' logo depois do '['. Um ']' logo depois da abertura faz parte do conjunto, e '\' faz o
+ * próximo caractere valer como letra. Os outros caracteres são convertidos pelo alfabeto; um
+ * caractere fora do alfabeto não aceita nenhuma letra.
+ *      Parâmetros:
+ *          text: Padrão (std::string_view).
+ **/
+template <typename Alphabet>
+structures::PrefixTree<Alphabet>::Pattern::Pattern(std::string_view text) {
+    std::size_t i = 0;
+
+    while (i < text.size()) {
+        Item item;
+        item.star = false;
+
+        if (text[i] == '*') {
+            ++i;
+            if (_items.empty() || !_items.back().star) {  // Sequências de '*' valem um só
+                item.star = true;
+                _items.push_back(item);
+            }
+            continue;
+        }
+
+        if (text[i] == '?') {
+            ++i;
+            item.letters.set();
+        } else if (text[i] == '[') {
+            ++i;
+            bool negate = i < text.size() && (text[i] == '^' || text[i] == '!');
+            if (negate) {
+                ++i;
+            }
+
+            for (bool first = true;; first = false) {
+                if (i >= text.size()) {
+                    throw std::out_of_range("Invalid pattern");
+                }
+                if (text[i] == ']' && !first) {
+                    ++i;
+                    break;
+                }
+
+                int low = next_letter(text, i);
+                int high = low;
+                if (i + 1 < text.size() && text[i] == '-' && text[i + 1] != ']') {
+                    ++i;
+                    high = next_letter(text, i);
+                }
+
+                if (low != AlphabetIndex::INVALID && high != AlphabetIndex::INVALID) {
+                    for (int key = low; key <= high; ++key) {
+                        item.letters.set(static_cast<std::size_t>(key));
+                    }
+                }
+            }
+
+            if (negate) {
+                item.letters.flip();
+            }
+        } else {
+            int key = next_letter(text, i);
+            if (key != AlphabetIndex::INVALID) {
+                item.letters.set(static_cast<std::size_t>(key));
+            }
+        }
+
+        _items.push_back(item);
+    }
+
+    // Um estado aceita qualquer continuação quando todos os itens seguintes são '*'
+    _universal.assign(_items.size(), false);
+    for (std::size_t j = _items.size(); j > 0 && _items[j - 1].star; --j) {
+        _universal[j - 1] = true;
+    }
+}
+
+/**
+ * Lê a próxima letra do padrão, pulando os bytes que o alfabeto ignora e tratando o '\'.
+ *      Parâmetros:
+ *          text: Padrão (std::string_view).
+ *          i: Posição (std::size_t&) do próximo byte, avança para depois da letra.
+ *      Retorno (int): Índice da letra, ou AlphabetIndex::INVALID caso não pertença ao alfabeto.
+ **/
+template <typename Alphabet>
+int structures::PrefixTree<Alphabet>::Pattern::next_letter(std::string_view text,
+                                                           std::size_t& i) {
+    while (i < text.size()) {
+        unsigned char byte = static_cast<unsigned char>(text[i++]);
+        if (byte == '\\') {
+            if (i >= text.size()) {
+                break;
+            }
+            byte = static_cast<unsigned char>(text[i++]);
+        }
+
+        int key = Alphabet::index(byte);
+        if (key != AlphabetIndex::SKIP) {
+            return key;
+        }
+    }
+
+    throw std::out_of_range("Invalid pattern");
+}
+
+/**
+ * Marca os estados alcançados sem consumir letras: depois de um '*' o item seguinte também pode
+ * ser esperado. Os estados são percorridos em ordem, então '*' seguidos se propagam.
+ *      Parâmetros:
+ *          set: Conjunto (unsigned char*) com uma marca por estado.
+ **/
+template <typename Alphabet>
+void structures::PrefixTree<Alphabet>::Pattern::close(unsigned char* set) const {
+    for (std::size_t i = 0; i < _items.size(); ++i) {
+        if (set[i] != 0 && _items[i].star) {
+            set[i + 1] = 1;
+        }
+    }
+}
+
+/**
+ * Preenche o conjunto inicial: o primeiro estado e os alcançados sem letras.
+ *      Parâmetros:
+ *          set: Conjunto (unsigned char*) com uma marca por estado.
+ **/
+template <typename Alphabet>
+void structures::PrefixTree<Alphabet>::Pattern::start(unsigned char* set) const {
+    for (std::size_t i = 0; i < states(); ++i) {
+        set[i] = 0;
+    }
+    set[0] = 1;
+    close(set);
+}
+
+/**
+ * Calcula o conjunto de estados depois de uma letra.
+ *      Parâmetros:
+ *          from: Conjunto (const unsigned char*) antes da letra.
+ *          key: Índice (unsigned char) da letra.
+ *          to: Conjunto (unsigned char*) depois da letra.
+ *      Retorno (bool): Falso caso o conjunto depois da letra esteja vazio.
+ **/
+template <typename Alphabet>
+bool structures::PrefixTree<Alphabet>::Pattern::step(const unsigned char* from, unsigned char key,
+                                                     unsigned char* to) const {
+    bool any = false;
+
+    for (std::size_t i = 0; i < states(); ++i) {
+        to[i] = 0;
+    }
+
+    for (std::size_t i = 0; i < _items.size(); ++i) {
+        if (from[i] == 0) {
+            continue;
+        }
+
+        if (_items[i].star) {  // O '*' consome a letra e continua esperando
+            to[i] = 1;
+            any = true;
+        } else if (_items[i].letters.test(key)) {
+            to[i + 1] = 1;
+            any = true;
+        }
+    }
+
+    close(to);
+    return any;
+}
+
+/**
+ * Retorna a única letra que os estados do conjunto aceitam, o que permite descer direto para o
+ * filho dela em vez de visitar todos os filhos.
+ *      Parâmetros:
+ *          set: Conjunto (const unsigned char*) de estados.
+ *      Retorno (int): Índice da letra (-1 caso nenhuma ou mais de uma letra seja aceita).
+ **/
+template <typename Alphabet>
+int structures::PrefixTree<Alphabet>::Pattern::single(const unsigned char* set) const {
+    std::bitset<Alphabet::SIZE> letters;
+
+    for (std::size_t i = 0; i < _items.size(); ++i) {
+        if (set[i] != 0) {
+            if (_items[i].star) {
+                return -1;
+            }
+            letters |= _items[i].letters;
+        }
+    }
+
+    if (letters.count() != 1) {
+        return -1;
+    }
+
+    for (std::size_t key = 0; key < Alphabet::SIZE; ++key) {
+        if (letters.test(key)) {
+            return static_cast<int>(key);
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Percorre em profundidade os nós cujo prefixo é um começo possível do padrão. Cada nível da
+ * descida guarda o conjunto de estados do autômato, e um filho só é visitado caso a sua letra
+ * leve a algum estado. Quando os estados esperam uma única letra, apenas o filho dela é lido.
+ *      Parâmetros:
+ *          pattern: Padrão compilado (const Pattern&).
+ *          whole_subtrees: Verdadeiro para entregar de uma vez as subárvores em que todos os
+ *              prefixos correspondem ao padrão, sem descer nelas.
+ *          visit: Função chamada com o nó (const Node*), o prefixo (const string&) e se o nó
+ *              representa a subárvore inteira (bool).
+ **/
+template <typename Alphabet>
+template <typename Visit>
+void structures::PrefixTree<Alphabet>::walk(const Pattern& pattern, bool whole_subtrees,
+                                            Visit visit) const {
+    const std::size_t width = pattern.states();
+    std::vector<unsigned char> sets(width);
+    pattern.start(sets.data());
+
+    // Um quadro com nó nulo representa a raiz. only guarda a única letra aceita, ou -1
+    struct Frame {
+        const Node* node;  // Nó cujos filhos estão sendo visitados
+        std::size_t slot;  // Posição do próximo filho
+        int only;          // Única letra aceita pelos estados do nó (-1 caso não exista)
+    };
+    std::vector<Frame> stack;
+    if (pattern.live(sets.data())) {
+        stack.push_back({nullptr, 0, pattern.single(sets.data())});
+    }
+
+    string word;  // Prefixo do nó do topo da pilha
+
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        const Node* child = nullptr;
+        unsigned char letter = 0;
+
+        if (frame.only >= 0) {
+            if (frame.slot == 0) {
+                frame.slot = 1;
+                letter = static_cast<unsigned char>(frame.only);
+                child = frame.node == nullptr ? _root[letter] : frame.node->child(letter);
+            }
+        } else if (frame.node == nullptr) {
+            while (child == nullptr && frame.slot < Alphabet::SIZE) {
+                letter = static_cast<unsigned char>(frame.slot);
+                child = _root[frame.slot++];
+            }
+        } else {
+            child = frame.node->next_child(frame.slot, letter);
+        }
+
+        if (child == nullptr) {  // Todos os filhos possíveis foram visitados
+            if (frame.node != nullptr) {
+                word.pop_back();
+            }
+            stack.pop_back();
+            continue;
+        }
+
+        const std::size_t depth = stack.size();
+        if (sets.size() < (depth + 1) * width) {
+            sets.resize((depth + 1) * width);
+        }
+        const unsigned char* from = &sets[(depth - 1) * width];
+        unsigned char* to = &sets[depth * width];
+
+        if (!pattern.step(from, letter, to)) {  // Nenhum estado aceita a letra
+            continue;
+        }
+
+        word.push_back(Alphabet::symbol(letter));
+
+        if (whole_subtrees && pattern.universal(to)) {
+            visit(child, word, true);
+            word.pop_back();
+            continue;
+        }
+
+        if (child->length() != 0 && pattern.accepts(to)) {
+            visit(child, word, false);
+        }
+
+        if (pattern.live(to)) {
+            stack.push_back({child, 0, pattern.single(to)});
+        } else {
+            word.pop_back();
+        }
     }
 }
 
+/**
+ * Retorna os prefixos que correspondem ao padrão, sem enumerar a árvore inteira: apenas os
+ * filhos compatíveis com os estados do autômato do padrão são visitados. '?' aceita uma letra,
+ * '*' aceita qualquer sequência e '[...]' aceita uma letra do conjunto (por exemplo "ab?c*" ou
+ * "[a-c]as[^a]").
+ *      Parâmetros:
+ *          pattern: Padrão (string).
+ *      Retorno (ArrayList<PatternMatch>): Prefixos encontrados em ordem alfabética.
+ **/
+template <typename Alphabet>
+structures::ArrayList<typename structures::PrefixTree<Alphabet>::PatternMatch>
+structures::PrefixTree<Alphabet>::match(const string& pattern) const {
+    ArrayList<PatternMatch> matches;
+
+    walk(Pattern(pattern), false, [&](const Node* node, const string& word, bool) {
+        matches.push_back({word, node->position(), node->length()});
+    });
+
+    return matches;
+}
+
+/**
+ * Retorna a quantidade de prefixos que correspondem ao padrão. Quando todos os prefixos de uma
+ * subárvore correspondem (o resto do padrão só tem '*'), a contagem de prefixos do nó é somada
+ * sem visitar a subárvore, como em prefix_search.
+ *      Parâmetros:
+ *          pattern: Padrão (string).
+ *      Retorno (unsigned long): Quantidade de prefixos.
+ **/
+template <typename Alphabet>
+unsigned long structures::PrefixTree<Alphabet>::match_count(const string& pattern) const {
+    unsigned long count = 0;
+
+    walk(Pattern(pattern), true, [&](const Node* node, const string&, bool subtree) {
+        count += subtree ? node->prefix_count() : 1;
+    });
+
+    return count;
+}
+
+/**
+ * Retorna o número de prefixos contidos em um prefixo.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) que está sendo procurado.
+ *      Retorno (unsigned long): Número de prefixos contidos em um prefixo.
+ **/
+template <typename Alphabet>
+unsigned long structures::PrefixTree<Alphabet>::prefix_search(const string& prefix) const {
+    return lookup(prefix).prefix_count;
+}
+
 /**
  * Retorna a posição do nó encontrado na pesquisa.
  *      Parâmetros:
  *          prefix: Prefíxo (string) que está sendo procurado.
- *      Retorno (unsigned long): Posição do nó encontrado (-1 caso não seja encontrado).
+ *      Retorno (unsigned long): Posição do nó encontrado (0 caso não seja encontrado).
  **/
-unsigned long structures::PrefixTree::position_search(const string& prefix) const {
-    if (_root[prefix[0] - ASCII_OFFSET] != nullptr) {  // Caso o filho do nó não seja nulo
-        // Pesquisa recursiva
-        return _root[prefix[0] - ASCII_OFFSET]->position_search(prefix, 1);
-    } else {
-        return 0;  // Nenhum prefixo encontrado
-    }
+template <typename Alphabet>
+unsigned long structures::PrefixTree<Alphabet>::position_search(const string& prefix) const {
+    return lookup(prefix).position;
 }
 
 /**
@@ -525,13 +2397,436 @@ unsigned long structures::PrefixTree::position_search(const string& prefix) cons
  *          prefix: Prefíxo (string) que está sendo procurado.
  *      Retorno (unsigned long): Comprimento do nó encontrado (0 caso não seja encontrado).
  **/
-unsigned long structures::PrefixTree::length_search(const string& prefix) const {
-    if (_root[prefix[0] - ASCII_OFFSET] != nullptr) {  // Caso o filho do nó não seja nulo
-        // Pesquisa recursiva
-        return _root[prefix[0] - ASCII_OFFSET]->length_search(prefix, 1);
-    } else {
-        return 0;  // Nenhum prefixo encontrado
+template <typename Alphabet>
+unsigned long structures::PrefixTree<Alphabet>::length_search(const string& prefix) const {
+    return lookup(prefix).length;
+}
+
+/**
+ * Pesquisa o prefixo e obtém todos os seus dados com uma única descida iterativa. O resultado é
+ * equivalente a chamar prefix_search, contains, position_search e length_search.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) que está sendo procurado.
+ *      Retorno (LookupResult): Quantidade de prefixos contidos, se o prefixo exato foi
+ *      encontrado, a sua posição e o seu comprimento.
+ **/
+template <typename Alphabet>
+structures::LookupResult structures::PrefixTree<Alphabet>::lookup(const string& prefix) const {
+    PREFIX_TREE_MEASURE(_operations.search);
+    return descend(prefix);
+}
+
+/**
+ * Pesquisa o prefixo como lookup, sem registrar a operação nos histogramas. Usado pelas
+ * operações que pesquisam antes de alterar a árvore.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) que está sendo procurado.
+ *      Retorno (LookupResult): Dados do prefixo.
+ **/
+template <typename Alphabet>
+structures::LookupResult structures::PrefixTree<Alphabet>::descend(const string& prefix) const {
+    LookupResult result = {0, false, 0, 0};
+    KeyReader reader(prefix);
+    int key;
+
+    // O prefixo vazio não corresponde a nenhum nó e um caractere fora do alfabeto não está na
+    // árvore
+    if (!reader.next(key) || key == AlphabetIndex::INVALID) {
+        return result;
+    }
+
+    // Desce pelos nós de cada letra até o fim do prefixo ou até encontrar um filho nulo
+    const Node* node = _root[key];
+    while (node != nullptr && reader.next(key)) {
+        node = key != AlphabetIndex::INVALID ? node->child(key) : nullptr;
+    }
+
+    if (node != nullptr) {  // O caminho do prefixo existe
+        result.prefix_count = node->prefix_count();
+
+        if (node->length() != 0) {  // O nó é o fim de um prefixo
+            result.found = true;
+            result.position = node->position();
+            result.length = node->length();
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Pesquisa vários prefixos de uma vez. As pesquisas são feitas em grupos que descem um nível
+ * por rodada: em cada rodada o próximo nó de cada pesquisa do grupo é pedido ao cache antes de
+ * qualquer um deles ser lido, então as esperas pela memória de pesquisas diferentes acontecem
+ * ao mesmo tempo em vez de uma depois da outra. O resultado de cada prefixo é o mesmo de
+ * lookup.
+ *      Parâmetros:
+ *          prefixes: Prefíxos (const string*) que estão sendo procurados.
+ *          results: Resultados (LookupResult*), na mesma ordem dos prefixos.
+ *          count: Quantidade (std::size_t) de prefixos.
+ **/
+template <typename Alphabet>
+void structures::PrefixTree<Alphabet>::lookup_batch(const string* prefixes,
+                                                    LookupResult* results,
+                                                    std::size_t count) const {
+    PREFIX_TREE_MEASURE(_operations.search, count);  // Cada pesquisa recebe a latência média
+    const Node* nodes[BATCH_GROUP];    // Nó atual de cada pesquisa do grupo
+    KeyReader readers[BATCH_GROUP];    // Letras ainda não percorridas de cada pesquisa
+    std::size_t active[BATCH_GROUP];   // Pesquisas que ainda estão descendo
+
+    for (std::size_t start = 0; start < count; start += BATCH_GROUP) {
+        std::size_t group = count - start < BATCH_GROUP ? count - start : BATCH_GROUP;
+        std::size_t remaining = 0;
+
+        // Primeira rodada: o filho da raiz de cada pesquisa
+        for (std::size_t q = 0; q < group; ++q) {
+            int key;
+            results[start + q] = {0, false, 0, 0};
+            readers[q] = KeyReader(prefixes[start + q]);
+
+            if (readers[q].next(key) && key != AlphabetIndex::INVALID) {
+                nodes[q] = _root[key];
+                if (nodes[q] != nullptr) {
+                    PREFETCH(nodes[q]);
+                    active[remaining++] = q;
+                }
+            }
+        }
+
+        // Cada rodada lê os nós pedidos na rodada anterior e pede os próximos
+        while (remaining > 0) {
+            std::size_t kept = 0;
+
+            for (std::size_t k = 0; k < remaining; ++k) {
+                std::size_t q = active[k];
+                const Node* node = nodes[q];
+                int key;
+
+                if (!readers[q].next(key)) {  // A pesquisa chegou ao fim do prefixo
+                    LookupResult& result = results[start + q];
+                    result.prefix_count = node->prefix_count();
+
+                    if (node->length() != 0) {  // O nó é o fim de um prefixo
+                        result.found = true;
+                        result.position = node->position();
+                        result.length = node->length();
+                    }
+                    continue;
+                }
+
+                const Node* child = key != AlphabetIndex::INVALID ? node->child(key) : nullptr;
+                if (child != nullptr) {  // O caminho continua
+                    PREFETCH(child);
+                    nodes[q] = child;
+                    active[kept++] = q;
+                }
+            }
+
+            remaining = kept;
+        }
+    }
+}
+
+/**
+ * Reescreve todos os nós em uma única região contígua, em uma ordem em que os nós de um mesmo
+ * caminho ficam próximos. Os níveis de cima, visitados por todas as pesquisas, são colocados em
+ * largura. Abaixo deles cada subárvore fica inteira em um trecho da região, em profundidade
+ * (SUBTREE_CLUSTERED) ou em van Emde Boas (VAN_EMDE_BOAS): a metade de cima da altura da
+ * subárvore é colocada primeiro, depois cada subárvore da metade de baixo, e cada parte é
+ * dividida da mesma forma. Cada nó ocupa o mesmo espaço que teria na arena do seu tipo, então a
+ * árvore continua aceitando inserções e remoções. Os nós antigos são liberados e os iteradores
+ * de complete se tornam inválidos. Uma árvore sem a arena passa a usar a arena depois disso.
+ *      Parâmetros:
+ *          breadth_levels: Quantidade (std::size_t) de níveis colocados em largura.
+ *          order: Ordem (LayoutOrder) das subárvores abaixo desses níveis.
+ *          huge_pages: Indica se a região deve usar páginas grandes.
+ **/
+template <typename Alphabet>
+void structures::PrefixTree<Alphabet>::relayout(std::size_t breadth_levels, LayoutOrder order,
+                                                bool huge_pages) {
+    if (_pool.size() == 0) {
+        return;
+    }
+
+    // Subárvore que ainda será colocada e quantos níveis dela entram (van Emde Boas)
+    struct Task {
+        const Node* node;
+        std::size_t levels;
+    };
+
+    std::vector<const Node*> sequence;  // Nós na ordem da nova região
+    sequence.reserve(_pool.size());
+
+    // Filhos de um nó em ordem alfabética
+    std::vector<const Node*> children;
+    auto collect = [&](const Node* node) {
+        children.clear();
+        node->for_each_child([&](unsigned char, const Node* child) { children.push_back(child); });
+    };
+
+    // Níveis de cima em largura. No fim, level tem as raízes das subárvores de baixo
+    std::vector<const Node*> level;
+    std::vector<const Node*> next;
+    for (std::size_t i = 0; i < Alphabet::SIZE; ++i) {
+        if (_root[i] != nullptr) {
+            level.push_back(_root[i]);
+        }
+    }
+    for (std::size_t depth = 0; depth < breadth_levels && !level.empty(); ++depth) {
+        next.clear();
+        for (const Node* node : level) {
+            sequence.push_back(node);
+            collect(node);
+            next.insert(next.end(), children.begin(), children.end());
+        }
+        level.swap(next);
+    }
+
+    std::vector<Task> stack;
+    for (const Node* subtree : level) {
+        if (order == SUBTREE_CLUSTERED) {  // Pré-ordem
+            stack.push_back({subtree, 0});
+            while (!stack.empty()) {
+                const Node* node = stack.back().node;
+                stack.pop_back();
+                sequence.push_back(node);
+
+                collect(node);
+                for (std::size_t i = children.size(); i > 0; --i) {
+                    stack.push_back({children[i - 1], 0});
+                }
+            }
+            continue;
+        }
+
+        // Altura da subárvore
+        std::size_t height = 0;
+        stack.push_back({subtree, 1});
+        while (!stack.empty()) {
+            Task task = stack.back();
+            stack.pop_back();
+            height = std::max(height, task.levels);
+
+            collect(task.node);
+            for (const Node* child : children) {
+                stack.push_back({child, task.levels + 1});
+            }
+        }
+
+        // Cada tarefa com mais de um nível é trocada pela sua metade de cima e pelas subárvores
+        // da metade de baixo, que ficam na pilha em ordem inversa para saírem em ordem
+        std::vector<Task> tasks;
+        std::vector<Task> bottoms;
+        tasks.push_back({subtree, height});
+        while (!tasks.empty()) {
+            Task task = tasks.back();
+            tasks.pop_back();
+
+            if (task.levels == 1) {
+                sequence.push_back(task.node);
+                continue;
+            }
+
+            std::size_t top = task.levels / 2;
+
+            // Nós a top níveis abaixo da raiz da tarefa, em ordem alfabética
+            bottoms.clear();
+            stack.push_back({task.node, 0});
+            while (!stack.empty()) {
+                Task visit = stack.back();
+                stack.pop_back();
+
+                if (visit.levels == top) {
+                    bottoms.push_back({visit.node, task.levels - top});
+                    continue;
+                }
+
+                collect(visit.node);
+                for (std::size_t i = children.size(); i > 0; --i) {
+                    stack.push_back({children[i - 1], visit.levels + 1});
+                }
+            }
+
+            tasks.insert(tasks.end(), bottoms.rbegin(), bottoms.rend());
+            tasks.push_back({task.node, top});
+        }
+    }
+
+    // Posição de cada nó na região, com o espaço e o alinhamento da arena do seu tipo
+    std::vector<std::size_t> offsets(sequence.size());
+    std::size_t counts[4] = {0, 0, 0, 0};
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < sequence.size(); ++i) {
+        bytes = (bytes + alignof(NodeFull) - 1) / alignof(NodeFull) * alignof(NodeFull);
+        offsets[i] = bytes;
+        bytes += NodePool::slot_size(sequence[i]->_type);
+        ++counts[sequence[i]->_type];
+    }
+
+    std::unordered_map<const Node*, Node*> moved;  // Cópia de cada nó
+    moved.reserve(sequence.size());
+
+    typename NodePool::Region region = NodePool::allocate_region(bytes, huge_pages);
+    try {
+        for (std::size_t i = 0; i < sequence.size(); ++i) {
+            const Node* node = sequence[i];
+            char* address = region.begin + offsets[i];
+            Node* copy;
+
+            switch (node->_type) {
+                case NODE4:
+                    copy = new (address) Node4(*static_cast<const Node4*>(node));
+                    break;
+                case NODE16:
+                    copy = new (address) Node16(*static_cast<const Node16*>(node));
+                    break;
+                case NODE48:
+                    copy = new (address) Node48(*static_cast<const Node48*>(node));
+                    break;
+                default:
+                    copy = new (address) NodeFull(*static_cast<const NodeFull*>(node));
+                    break;
+            }
+
+            moved.emplace(node, copy);
+        }
+    } catch (...) {
+        NodePool::release_region(region);
+        throw;
+    }
+
+    // As cópias ainda apontam para os filhos antigos
+    unsigned char keys[Alphabet::SIZE];
+    for (const auto& entry : moved) {
+        Node* copy = entry.second;
+        std::size_t count = 0;
+        copy->for_each_child([&](unsigned char key, const Node*) { keys[count++] = key; });
+
+        for (std::size_t i = 0; i < count; ++i) {
+            Node** slot = copy->find_child(keys[i]);
+            *slot = moved.find(*slot)->second;
+        }
+    }
+
+    for (std::size_t i = 0; i < Alphabet::SIZE; ++i) {
+        if (_root[i] != nullptr) {
+            _root[i] = moved.find(_root[i])->second;
+        }
     }
+
+    // Sem a arena os nós antigos são liberados um a um. Os nós da região são devolvidos às
+    // arenas, que passam a usar blocos
+    if (!_pool.pooled()) {
+        for (const Node* node : sequence) {
+            _pool.deallocate(const_cast<Node*>(node));
+        }
+    }
+
+    _pool.adopt(region, counts);
+}
+
+/**
+ * Percorre todos os nós e retorna a forma e a memória da árvore. Os espaços de filhos são os
+ * ponteiros de cada nó (4, 16, 48 ou um por letra, conforme o tipo) e os da raiz. Os bytes
+ * desperdiçados contam os ponteiros sem filho e as chaves ou índices sem uso.
+ *      Retorno (Stats): Contagens, bytes e histogramas de profundidade e de filhos.
+ **/
+template <typename Alphabet>
+typename structures::PrefixTree<Alphabet>::Stats structures::PrefixTree<Alphabet>::stats() const {
+    Stats stats;
+    stats.prefixes = size();
+    stats.nodes_by_type[NODE4] = _pool._arena4.size();
+    stats.nodes_by_type[NODE16] = _pool._arena16.size();
+    stats.nodes_by_type[NODE48] = _pool._arena48.size();
+    stats.nodes_by_type[NODEFULL] = _pool._arenafull.size();
+    stats.nodes = _pool.size();
+    stats.bytes_in_use = sizeof(_root) + _pool._arena4.used_bytes() + _pool._arena16.used_bytes() +
+                         _pool._arena48.used_bytes() + _pool._arenafull.used_bytes();
+    stats.bytes_reserved = sizeof(_root) + _pool._arena4.reserved_bytes() +
+                           _pool._arena16.reserved_bytes() + _pool._arena48.reserved_bytes() +
+                           _pool._arenafull.reserved_bytes() + _pool.region_bytes();
+
+    // Percurso em profundidade com pilha explícita, já que a altura não tem limite
+    std::vector<std::pair<const Node*, std::size_t>> stack;
+    stats.child_slots = Alphabet::SIZE;
+    for (std::size_t i = 0; i < Alphabet::SIZE; ++i) {
+        if (_root[i] != nullptr) {
+            stack.push_back({_root[i], 1});
+        }
+    }
+    stats.empty_slots = Alphabet::SIZE - stack.size();
+    stats.wasted_bytes = stats.empty_slots * sizeof(Node*);
+
+    while (!stack.empty()) {
+        const Node* node = stack.back().first;
+        std::size_t depth = stack.back().second;
+        std::size_t children = node->_child_count;
+        stack.pop_back();
+
+        // Capacidade e bytes por espaço vazio de cada tipo de nó
+        std::size_t capacity, empty_bytes;
+        switch (node->_type) {
+            case NODE4:
+                capacity = 4;
+                empty_bytes = (capacity - children) * (sizeof(Node*) + 1);
+                break;
+            case NODE16:
+                capacity = 16;
+                empty_bytes = (capacity - children) * (sizeof(Node*) + 1);
+                break;
+            case NODE48:
+                capacity = 48;
+                empty_bytes = (capacity - children) * sizeof(Node*) + Alphabet::SIZE - children;
+                break;
+            default:
+                capacity = Alphabet::SIZE;
+                empty_bytes = (capacity - children) * sizeof(Node*);
+                break;
+        }
+
+        stats.child_slots += capacity;
+        stats.empty_slots += capacity - children;
+        stats.wasted_bytes += empty_bytes;
+
+        if (depth >= stats.depth_histogram.size()) {
+            stats.depth_histogram.resize(depth + 1, 0);
+            stats.max_depth = depth;
+        }
+        ++stats.depth_histogram[depth];
+
+        if (children >= stats.fanout_histogram.size()) {
+            stats.fanout_histogram.resize(children + 1, 0);
+        }
+        ++stats.fanout_histogram[children];
+
+        std::size_t slot = 0;
+        unsigned char key;
+        for (const Node* child = node->next_child(slot, key); child != nullptr;
+             child = node->next_child(slot, key)) {
+            stack.push_back({child, depth + 1});
+        }
+    }
+
+    return stats;
+}
+
+#if defined(PREFIX_TREE_STATS)
+/**
+ * Retorna os histogramas de latência (const OperationStats&) de inserção, pesquisa e remoção.
+ * Só existe quando PREFIX_TREE_STATS está definido.
+ **/
+template <typename Alphabet>
+const structures::OperationStats& structures::PrefixTree<Alphabet>::operations() const {
+    return _operations;
+}
+
+/**
+ * Zera os histogramas de latência das operações.
+ **/
+template <typename Alphabet>
+void structures::PrefixTree<Alphabet>::reset_operations() {
+    _operations.reset();
 }
+#endif
 
 #endif
@@ -0,0 +1,452 @@
+// Copyright [2021] <Eric Fernandes Evaristo>
+// v1.0.1
+
+#ifndef STRUCTURES_RADIX_TREE_H
+#define STRUCTURES_RADIX_TREE_H
+
+#include <cstdint>    // std::size_t
+#include <stdexcept>  // C++ exceptions
+#include <string>
+
+#include "array_list.h"
+#include "lookup_result.h"
+
+using std::string;
+
+namespace structures {
+
+// Classe RadixTree, árvore de prefixos com compressão de caminhos. Cada nó guarda o trecho
+// (rótulo) de todos os caracteres de uma cadeia de nós com um único filho
+class RadixTree {
+   public:
+    // Construtor
+    RadixTree();
+    // Destrutor
+    ~RadixTree();
+    // Insere um prefixo
+    void insert(const string& prefix, unsigned long position, unsigned long length);
+    // Remove um prefixo
+    void remove(const string& prefix);
+    // Verifica se contém um prefixo
+    bool contains(const string& prefix) const;
+    // Verifica se a árvore está vazia
+    bool empty() const;
+    // Retorna o tamanho da árvore
+    std::size_t size() const;
+    // Retorna a quantidade de nós da árvore
+    std::size_t node_count() const;
+    // Retorna uma lista de prefixos em ordem alfabética
+    ArrayList<string> aphabetical_order() const;
+    // Retorna o número de prefixos contidos no prefixo do parâmetro
+    unsigned long prefix_search(const string& prefix) const;
+    // Retorna a posição do prefixo
+    unsigned long position_search(const string& prefix) const;
+    // Retorna o comprimento da linha do prefixo
+    unsigned long length_search(const string& prefix) const;
+    // Retorna todos os dados do prefixo com uma única descida na árvore
+    LookupResult lookup(const string& prefix) const;
+
+    RadixTree(const RadixTree&) = delete;
+    RadixTree& operator=(const RadixTree&) = delete;
+
+   private:
+    // Estrutura de nó que descreve um trecho do prefixo
+    struct Node {
+        string _label;                // Trecho do prefixo entre o pai e este nó
+        string _keys;                 // Primeiro caractere do rótulo de cada filho, em ordem
+        Node** _children;             // Filhos na mesma ordem das chaves
+        unsigned long _position;      // Posição
+        unsigned long _length;        // Comprimento
+        unsigned long _prefix_count;  // Quantidade de prefixos contidos abaixo deste nó
+
+        /**
+         * Constrói uma estrutura structures::RadixTree::Node.
+         *      Parâmetros:
+         *          label: Trecho (string) do prefixo guardado no nó.
+         **/
+        explicit Node(const string& label) : _label(label) {
+            _children = nullptr;
+            _position = 0;
+            _length = 0;
+            _prefix_count = 0;
+        }
+
+        /**
+         * Destrói o nó e todos os nós abaixo dele.
+         **/
+        ~Node() {
+            for (std::size_t i = 0; i < _keys.length(); ++i) {
+                delete _children[i];
+            }
+
+            delete[] _children;
+        }
+
+        /**
+         * Procura o espaço do filho cujo rótulo começa com o caractere.
+         *      Parâmetros:
+         *          key: Primeiro caractere (char) do rótulo.
+         *      Retorno (Node**): Espaço que guarda o filho (nullptr caso não exista).
+         **/
+        Node** find_child(char key) const {
+            for (std::size_t i = 0; i < _keys.length() && _keys[i] <= key; ++i) {
+                if (_keys[i] == key) {
+                    return &_children[i];
+                }
+            }
+
+            return nullptr;
+        }
+
+        /**
+         * Adiciona um filho mantendo a ordem alfabética das chaves.
+         *      Parâmetros:
+         *          child: Filho (Node*) a ser adicionado.
+         **/
+        void add_child(Node* child) {
+            std::size_t count = _keys.length();
+            std::size_t index = 0;
+            while (index < count && _keys[index] < child->_label[0]) {
+                ++index;
+            }
+
+            // O vetor de filhos é realocado com o tamanho exato, pois poucos nós mudam depois
+            // da construção
+            Node** children = new Node*[count + 1];
+            for (std::size_t i = 0; i < index; ++i) {
+                children[i] = _children[i];
+            }
+            children[index] = child;
+            for (std::size_t i = index; i < count; ++i) {
+                children[i + 1] = _children[i];
+            }
+
+            delete[] _children;
+            _children = children;
+            _keys.insert(index, 1, child->_label[0]);
+        }
+
+        /**
+         * Remove o filho cujo rótulo começa com o caractere (sem deletá-lo).
+         *      Parâmetros:
+         *          key: Primeiro caractere (char) do rótulo.
+         **/
+        void remove_child(char key) {
+            std::size_t index = _keys.find(key);
+            for (std::size_t i = index; i + 1 < _keys.length(); ++i) {
+                _children[i] = _children[i + 1];
+            }
+
+            _keys.erase(index, 1);
+        }
+
+        /**
+         * Absorve o único filho deste nó, juntando os dois rótulos. Só pode ser chamado quando
+         * este nó não é o fim de um prefixo e tem exatamente um filho.
+         **/
+        void merge_child() {
+            Node* child = _children[0];
+
+            _label += child->_label;
+            _keys.swap(child->_keys);
+            delete[] _children;
+            _children = child->_children;
+            _position = child->_position;
+            _length = child->_length;
+
+            // O filho já não possui nenhum nó abaixo dele
+            child->_children = nullptr;
+            child->_keys.clear();
+            delete child;
+        }
+
+        /**
+         * Remove o prefixo de forma recursiva. Os nós que ficarem sem prefixos são deletados
+         * e os nós que sobrarem com um único filho e sem dados são unidos a ele.
+         *      Parâmetros:
+         *          ref: Ponteiro (Node*&) que referencia o nó (nulo caso o nó seja deletado).
+         *          prefix: Prefíxo (string) a ser removido.
+         *          index: Índice (std::size_t) do primeiro caractere do rótulo deste nó.
+         **/
+        static void remove(Node*& ref, const string& prefix, std::size_t index) {
+            Node* node = ref;
+            index += node->_label.length();
+
+            if (index < prefix.length()) {  // O nó alvo está abaixo deste nó
+                Node** slot = node->find_child(prefix[index]);
+                remove(*slot, prefix, index);
+
+                if (*slot == nullptr) {
+                    node->remove_child(prefix[index]);
+                }
+            } else {  // Este nó é o alvo, então os seus dados são apagados
+                node->_position = 0;
+                node->_length = 0;
+            }
+
+            --node->_prefix_count;
+
+            if (node->_prefix_count == 0) {  // Não há mais prefixos abaixo do nó
+                delete node;
+                ref = nullptr;
+            } else if (node->_length == 0 && node->_keys.length() == 1) {
+                node->merge_child();  // O nó virou um elo de uma cadeia e é comprimido
+            }
+        }
+
+        /**
+         * Retorna uma lista com todos os prefixos abaixo deste nó (recursivamente).
+         *      Parâmetros:
+         *          prefix: Prefíxo (string) que está sendo construído.
+         *          list: Lista (ArrayList<string>) com os prefixos.
+         **/
+        void alphabetical_order(const string& prefix, ArrayList<string>& list) const {
+            string new_prefix(prefix + _label);
+
+            if (_length != 0) {
+                list.push_back(new_prefix);
+            }
+
+            for (std::size_t i = 0; i < _keys.length(); ++i) {
+                _children[i]->alphabetical_order(new_prefix, list);
+            }
+        }
+
+        /**
+         * Retorna a quantidade de nós abaixo deste nó, incluindo ele (recursivamente).
+         **/
+        std::size_t node_count() const {
+            std::size_t count = 1;
+            for (std::size_t i = 0; i < _keys.length(); ++i) {
+                count += _children[i]->node_count();
+            }
+
+            return count;
+        }
+    };
+
+    Node* _root;        // Raiz (rótulo vazio)
+    std::size_t _size;  // Tamanho da árvore
+};
+
+}  // namespace structures
+
+/**
+ * Constrói um objeto structures::RadixTree.
+ **/
+inline structures::RadixTree::RadixTree() {
+    _root = new Node("");
+    _size = 0u;
+}
+
+/**
+ * Destrói o objeto structures::RadixTree.
+ **/
+inline structures::RadixTree::~RadixTree() {
+    delete _root;  // Cada nó deleta os nós abaixo dele
+}
+
+/**
+ * Insere o prefixo. Os rótulos são divididos no ponto em que o prefixo se separa deles, e a
+ * contagem do novo nó de divisão é a mesma do nó dividido.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) a ser inserido.
+ *          position: Posição (unsigned long) do caractere no arquivo.
+ *          length: Comprimento (unsigned long) da linha do prefixo.
+ **/
+inline void structures::RadixTree::insert(const string& prefix, unsigned long position,
+                                          unsigned long length) {
+    if (prefix.empty()) {
+        throw std::out_of_range("Empty prefix");
+    }
+
+    Node* node = _root;
+    std::size_t index = 0;
+    node->_prefix_count++;
+
+    while (index < prefix.length()) {
+        Node** slot = node->find_child(prefix[index]);
+
+        if (slot == nullptr) {  // Nenhum filho começa com o caractere, o resto vira uma folha
+            Node* leaf = new Node(prefix.substr(index));
+            leaf->_prefix_count = 1;
+            leaf->_position = position;
+            leaf->_length = length;
+            node->add_child(leaf);
+            ++_size;
+            return;
+        }
+
+        // Mede o trecho em comum entre o rótulo do filho e o resto do prefixo
+        Node* child = *slot;
+        std::size_t common = 1;
+        while (common < child->_label.length() && index + common < prefix.length() &&
+               child->_label[common] == prefix[index + common]) {
+            ++common;
+        }
+
+        if (common < child->_label.length()) {  // O prefixo se separa no meio do rótulo
+            Node* split = new Node(child->_label.substr(0, common));
+            split->_prefix_count = child->_prefix_count;
+            child->_label.erase(0, common);
+
+            split->_children = new Node*[1];
+            split->_children[0] = child;
+            split->_keys.push_back(child->_label[0]);
+            *slot = split;
+            child = split;
+        }
+
+        child->_prefix_count++;
+        node = child;
+        index += common;
+    }
+
+    // O prefixo termina exatamente em um nó
+    node->_position = position;
+    node->_length = length;
+    ++_size;
+}
+
+/**
+ * Remove o prefixo.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) a ser removido.
+ **/
+inline void structures::RadixTree::remove(const string& prefix) {
+    if (contains(prefix)) {  // Checa se o prefixo está na árvore
+        Node** slot = _root->find_child(prefix[0]);
+        Node::remove(*slot, prefix, 0);
+
+        if (*slot == nullptr) {
+            _root->remove_child(prefix[0]);
+        }
+
+        _root->_prefix_count--;
+        --_size;
+    } else {
+        throw std::out_of_range("Prefix not found");
+    }
+}
+
+/**
+ * Verifica se o prefixo está contido.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) a ser verificado.
+ *      Retorno (bool): valor que indica se o fim do prefixo foi encontrado ou não.
+ **/
+inline bool structures::RadixTree::contains(const string& prefix) const {
+    return lookup(prefix).found;
+}
+
+/**
+ * Retorna verdadeiro caso a árvore esteja vazia.
+ **/
+inline bool structures::RadixTree::empty() const { return size() == 0; }
+
+/**
+ * Retorna o tamanho (std::size_t).
+ **/
+inline std::size_t structures::RadixTree::size() const { return _size; }
+
+/**
+ * Retorna a quantidade de nós (std::size_t), sem contar a raiz.
+ **/
+inline std::size_t structures::RadixTree::node_count() const { return _root->node_count() - 1; }
+
+/**
+ * Retorna uma lista (ArrayList<string>) com todos os prefixos em ordem alfabética.
+ **/
+inline structures::ArrayList<string> structures::RadixTree::aphabetical_order() const {
+    structures::ArrayList<string> list(size());
+
+    if (!empty()) {
+        _root->alphabetical_order("", list);
+    }
+
+    return list;
+}
+
+/**
+ * Retorna o número de prefixos contidos em um prefixo.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) que está sendo procurado.
+ *      Retorno (unsigned long): Número de prefixos contidos em um prefixo.
+ **/
+inline unsigned long structures::RadixTree::prefix_search(const string& prefix) const {
+    return lookup(prefix).prefix_count;
+}
+
+/**
+ * Retorna a posição do nó encontrado na pesquisa.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) que está sendo procurado.
+ *      Retorno (unsigned long): Posição do nó encontrado (0 caso não seja encontrado).
+ **/
+inline unsigned long structures::RadixTree::position_search(const string& prefix) const {
+    return lookup(prefix).position;
+}
+
+/**
+ * Retorna o comprimento do nó encontrado na pesquisa.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) que está sendo procurado.
+ *      Retorno (unsigned long): Comprimento do nó encontrado (0 caso não seja encontrado).
+ **/
+inline unsigned long structures::RadixTree::length_search(const string& prefix) const {
+    return lookup(prefix).length;
+}
+
+/**
+ * Pesquisa o prefixo e obtém todos os seus dados com uma única descida iterativa. Um prefixo
+ * que termina no meio de um rótulo contém os mesmos prefixos que o nó do rótulo.
+ *      Parâmetros:
+ *          prefix: Prefíxo (string) que está sendo procurado.
+ *      Retorno (LookupResult): Quantidade de prefixos contidos, se o prefixo exato foi
+ *      encontrado, a sua posição e o seu comprimento.
+ **/
+inline structures::LookupResult structures::RadixTree::lookup(const string& prefix) const {
+    LookupResult result = {0, false, 0, 0};
+
+    if (prefix.empty()) {  // O prefixo vazio não corresponde a nenhum nó
+        return result;
+    }
+
+    const Node* node = _root;
+    std::size_t index = 0;
+
+    while (index < prefix.length()) {
+        Node** slot = node->find_child(prefix[index]);
+        if (slot == nullptr) {
+            return result;
+        }
+
+        // Compara o rótulo do filho com o resto do prefixo
+        node = *slot;
+        std::size_t label_length = node->_label.length();
+        std::size_t compared = prefix.length() - index < label_length ? prefix.length() - index
+                                                                      : label_length;
+        if (node->_label.compare(0, compared, prefix, index, compared) != 0) {
+            return result;
+        }
+
+        if (compared < label_length) {  // O prefixo termina no meio do rótulo
+            result.prefix_count = node->_prefix_count;
+            return result;
+        }
+
+        index += label_length;
+    }
+
+    result.prefix_count = node->_prefix_count;
+
+    if (node->_length != 0) {  // O nó é o fim de um prefixo
+        result.found = true;
+        result.position = node->_position;
+        result.length = node->_length;
+    }
+
+    return result;
+}
+
+#endif
@@ -1,89 +1,200 @@
 // Copyright [2021] <Eric Fernandes Evaristo>
 // v1.0.1
 
+#include <dictionary.h>
+#include <double_array_trie.h>
+#include <lookup_pipeline.h>
 #include <prefix_tree.h>
 
-#include <fstream>
+#include <algorithm>  // std::max
+#include <exception>
 #include <iostream>
 #include <string>
+#include <thread>
 
 using namespace std;
-using structures::ArrayList;
-using structures::PrefixTree;
+using structures::Dictionary;
+using structures::DoubleArrayTrie;
+using structures::LookupPipeline;
+using structures::LookupResult;
+using structures::Utf8Folded;
+
+/**
+ * Acrescenta a resposta de uma pesquisa em um texto, no formato exibido pelo programa.
+ *      Parâmetros:
+ *          word: Palavra (const string&) pesquisada.
+ *          result: Dados (const LookupResult&) do prefixo pesquisado.
+ *          output: Texto (string&) que recebe as linhas da resposta.
+ **/
+void format_result(const string& word, const LookupResult& result, string& output) {
+    if (result.prefix_count > 0) {  // Existem prefixos contidos na palavra
+        // Exibe a quantidade de prefixos contidos
+        output.append(word).append(" is prefix of ");
+        output.append(to_string(result.prefix_count)).append(" words\n");
+
+        // Caso a palavra corresponda a um prefixo exato, a posição e o comprimento serão
+        // exibidos
+        if (result.found) {
+            output.append(word).append(" is at (").append(to_string(result.position));
+            output.append(",").append(to_string(result.length)).append(")\n");
+        }
+    } else {  // Não há nenhum prefixo contido na palavra
+        output.append(word).append(" is not prefix\n");
+    }
+}
 
-int main() {
-    string filename;         // Nome do arquivo
-    string word;             // Palavra a ser pesquisada
-    PrefixTree prefix_tree;  // Árvore de prefixos
-    std::ifstream dicFile;   // Arquivo que será lido
+/**
+ * Lê as palavras da entrada até encontrar "0" e exibe os dados de cada uma. Cada resposta é
+ * exibida assim que a palavra é lida, então a entrada pode ser interativa.
+ *      Parâmetros:
+ *          index: Índice (Dictionary ou DoubleArrayTrie) que responde as pesquisas.
+ **/
+template <typename Index>
+void answer_queries(const Index& index) {
+    string word;    // Palavra a ser pesquisada
+    string output;  // Resposta da palavra
 
-    cin >> filename;  // Entrada do nome do arquivo
+    while (1) {  // leitura das palavras até encontrar "0"
+        cin >> word;
 
-    dicFile.open(filename);  // Tenta abrir o arquivo
-
-    // Se o arquivo está aberto o seu conteúdo é lido e árvore de prefixos é construída
-    if (dicFile.is_open()) {
-        bool reading_prefix;         // Booleano de estado de leitura
-        string line;                 // String para a linha
-        string prefix = "";          // String para o prefixo
-        unsigned long position = 0;  // Posição do caractere
-
-        // Enquanto não for o fim do texto, lê linha por linha
-        while (getline(dicFile, line)) {
-            // Itera por cada caractere na linha
-            for (std::size_t i = 0; i < line.size(); ++i) {
-                // No primeiro caractere o estado de leitura é definido como verdadeiro. Na leitura
-                // o caractere é adicionado no string do prefixo enquanto o caractere for válido.
-                // Assim que o caractere não for válido o estado de leitura é redefinido como falso
-                if (i == 0) {
-                    reading_prefix = true;
-                } else if (reading_prefix && (line[i] >= 'a' && line[i] <= 'z')) {
-                    prefix.push_back(line[i]);
-                } else {
-                    reading_prefix = false;
-                }
-            }
-
-            prefix_tree.insert(prefix, position, line.size());  // Insere o prefixo na árvore
-            prefix.clear();                                     // Limpa o string de prefixos
-            position += line.size() + 1;                        // Calcula a posição
+        if (word.compare("0") == 0) {
+            break;
         }
 
-        dicFile.close();  // Fecha o arquivo
+        // Obtém a quantidade de prefixos contidos na palavra, a posição e o comprimento do
+        // prefixo exato em uma única pesquisa
+        output.clear();
+        format_result(word, index.lookup(word), output);
+
+        // A saída é esvaziada antes de cada leitura de cin, então não é preciso usar endl
+        cout << output;
+    }
+}
+
+/**
+ * Responde todas as palavras da entrada com o pipeline de pesquisas. A entrada é lida em blocos
+ * grandes, as pesquisas são feitas em paralelo e as respostas são exibidas na ordem da entrada,
+ * no mesmo formato de answer_queries.
+ *      Parâmetros:
+ *          index: Índice (Dictionary ou DoubleArrayTrie) que responde as pesquisas.
+ *          threads: Quantidade (unsigned) de threads de pesquisa.
+ **/
+template <typename Index>
+void answer_pipeline(const Index& index, unsigned threads) {
+    LookupPipeline pipeline(threads);
+
+    pipeline.run(index, cin, cout, format_result);
+}
+
+/**
+ * Responde as pesquisas com o modo escolhido.
+ *      Parâmetros:
+ *          index: Índice (Dictionary ou DoubleArrayTrie) que responde as pesquisas.
+ *          pipeline: Indica se o pipeline de pesquisas deve ser usado.
+ *          threads: Quantidade (unsigned) de threads de pesquisa do pipeline.
+ **/
+template <typename Index>
+void answer(const Index& index, bool pipeline, unsigned threads) {
+    if (pipeline) {
+        answer_pipeline(index, threads);
     } else {
-        throw std::out_of_range("File not found");
+        answer_queries(index);
     }
+}
 
-    unsigned long prefix_count;  // Quantidade de prefixos contidos em um prefixo
-    unsigned long position;      // Posição do prefixo no arquivo
-    unsigned long length;        // Comprimento da linha
+/**
+ * Lê a quantidade de threads do pipeline. Só são aceitos números decimais de 1 até quatro vezes a
+ * quantidade de núcleos, então valores negativos não dão a volta para números enormes.
+ *      Parâmetros:
+ *          value: Texto (const string&) da opção.
+ *          threads: Quantidade (unsigned&) que recebe o valor lido.
+ *      Retorno (bool): Indica se o valor é válido.
+ **/
+bool parse_threads(const string& value, unsigned& threads) {
+    const unsigned long limit = 4ul * max(thread::hardware_concurrency(), 1u);
+    unsigned long count;
+
+    if (value.empty() || value.find_first_not_of("0123456789") != string::npos) {
+        return false;
+    }
 
-    while (1) {  // leitura das palavras até encontrar "0"
-        cin >> word;
+    try {
+        count = stoul(value);
+    } catch (const exception&) {
+        return false;
+    }
 
-        if (word.compare("0") == 0) {
-            break;
+    if (count == 0 || count > limit) {
+        return false;
+    }
+
+    threads = static_cast<unsigned>(count);
+    return true;
+}
+
+// Uso: main [--pipeline [--threads N]] [--save-index ARQUIVO]
+// O modo --pipeline é indicado para entradas grandes vindas de arquivos ou de outros programas;
+// sem ele cada palavra é respondida assim que é lida. Com --save-index a árvore construída do
+// dicionário também é gravada em um arquivo de índice, que pode ser lido no lugar do dicionário
+int main(int argc, char* argv[]) {
+    string filename;        // Nome do arquivo
+    string index_filename;  // Nome do arquivo de índice a ser gravado (vazio caso não seja)
+    bool pipeline = false;
+    bool threads_given = false;  // Indica se --threads foi usado
+    bool valid = true;           // Indica se as opções são válidas
+    unsigned threads = thread::hardware_concurrency();
+
+    for (int i = 1; i < argc && valid; ++i) {
+        string option = argv[i];
+
+        if (option == "--pipeline") {
+            pipeline = true;
+        } else if (option == "--threads" && i + 1 < argc) {
+            threads_given = true;
+            valid = parse_threads(argv[++i], threads);
+        } else if (option == "--save-index" && i + 1 < argc) {
+            index_filename = argv[++i];
+        } else {
+            valid = false;
         }
+    }
 
-        // Obtém a quantidade de prefixos contidos na palavra
-        prefix_count = prefix_tree.prefix_search(word);
+    // A quantidade de threads só vale para o pipeline
+    if (!valid || (threads_given && !pipeline)) {
+        cerr << "Usage: " << argv[0] << " [--pipeline [--threads N]] [--save-index FILE]" << endl;
+        return 1;
+    }
 
-        if (prefix_count > 0) {  // Existem prefixos contidos na palavra
-            // Exibe a quantidade de prefixos contidos
-            cout << word << " is prefix of " << prefix_count << " words" << endl;
+    // O pipeline lê a entrada diretamente do buffer de cin, sem sincronizar com stdio
+    if (pipeline) {
+        ios::sync_with_stdio(false);
+    }
 
-            position = prefix_tree.position_search(word);  // Obtém a posição do prefixo exato
-            length = prefix_tree.length_search(word);      // Obtém o comprimento do prefixo exato
+    cin >> filename;  // Entrada do nome do arquivo
 
-            // Caso a palavra corresponda a um prefixo exato, a posição e o comprimento serão
-            // exibidos
-            if (length != 0) {
-                cout << word << " is at (" << position << "," << length << ")" << endl;
-            }
-        } else {  // Não há nenhum prefixo contido na palavra
-            cout << word << " is not prefix" << endl;
+    // Um arquivo de índice gravado por PrefixTree::save é mapeado e consultado diretamente, sem
+    // reconstruir a árvore
+    if (DoubleArrayTrie::is_index(filename)) {
+        if (!index_filename.empty()) {
+            cerr << filename << " is already an index file" << endl;
+            return 1;
         }
+
+        answer(DoubleArrayTrie::load(filename), pipeline, threads);
+        return 0;
     }
 
+    // O dicionário mapeia o arquivo na memória e constrói a árvore de prefixos a partir das
+    // linhas dele. As subárvores de cada letra são construídas em paralelo. Palavras em UTF-8
+    // são aceitas sem diferenciar acentos e maiúsculas, e o índice gravado guarda a mesma tabela
+    // do alfabeto, então as pesquisas no índice dão as mesmas respostas
+    Dictionary<Utf8Folded> dictionary(filename);
+
+    if (!index_filename.empty()) {
+        dictionary.tree().save(index_filename);
+    }
+
+    answer(dictionary, pipeline, threads);
+
     return 0;
 }